@@ -12,17 +12,28 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <memory>
+#include <new>
+
 #include "common/macros.h"
 
 namespace bustub {
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager,
-                                                     LogManager *log_manager)
-    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager) {}
+                                                     LogManager *log_manager, ReplacerType replacer_type,
+                                                     bool use_huge_pages, size_t max_pool_size)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager, replacer_type, use_huge_pages,
+                                max_pool_size) {}
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
-                                                     DiskManager *disk_manager, LogManager *log_manager)
+                                                     DiskManager *disk_manager, LogManager *log_manager,
+                                                     ReplacerType replacer_type, bool use_huge_pages,
+                                                     size_t max_pool_size)
     : pool_size_(pool_size),
+      max_pool_size_(max_pool_size == 0 ? pool_size : max_pool_size),
       num_instances_(num_instances),
       instance_index_(instance_index),
       next_page_id_(instance_index),
@@ -32,45 +43,523 @@ BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t
   BUSTUB_ASSERT(
       instance_index < num_instances,
       "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 1.");
-  // We allocate a consecutive memory space for the buffer pool.
-  pages_ = new Page[pool_size_];
-  replacer_ = new LRUReplacer(pool_size);
+  BUSTUB_ASSERT(pool_size <= max_pool_size_, "The buffer pool cannot start out larger than its maximum size.");
+  // We allocate a consecutive memory space for the buffer pool. A standalone instance has no preferred NUMA node.
+  // Room is reserved for the maximum size up front, so that growing never moves a frame; the operating system only
+  // backs the frames that are touched.
+  frame_arena_ =
+      new FrameArena(max_pool_size_, use_huge_pages, num_instances > 1 ? static_cast<int>(instance_index) : -1);
+  // The frame headers that scans over the pool read are kept in their own table, apart from the pages.
+  frame_headers_ = static_cast<FrameHeader *>(
+      ::operator new[](max_pool_size_ * sizeof(FrameHeader), std::align_val_t(CACHE_LINE_SIZE)));
+  pages_ = static_cast<Page *>(::operator new[](max_pool_size_ * sizeof(Page), std::align_val_t(alignof(Page))));
+  switch (replacer_type) {
+    case ReplacerType::LRU:
+      replacer_ = new LRUReplacer(max_pool_size_);
+      break;
+    case ReplacerType::LRU_K:
+      replacer_ = new LRUKReplacer(max_pool_size_);
+      break;
+    case ReplacerType::CLOCK:
+      replacer_ = new ClockReplacer(max_pool_size_);
+      break;
+  }
+
+  disk_scheduler_ = new DiskScheduler(disk_manager_);
 
   // Initially, every page is in the free list.
-  for (size_t i = 0; i < pool_size_; ++i) {
+  for (size_t i = 0; i < pool_size; ++i) {
+    new (&frame_headers_[i]) FrameHeader();
+    new (&pages_[i]) Page(&frame_headers_[i], frame_arena_->GetFrame(static_cast<frame_id_t>(i)));
     free_list_.emplace_back(static_cast<int>(i));
   }
+  num_frames_ = pool_size;
+
+  // The pages of an existing database file are either in use or in the free-page map, so new ids start past its end.
+  page_id_t num_pages = disk_manager_->GetNumPages();
+  next_page_id_ = num_pages + (instance_index_ + num_instances_ - num_pages % num_instances_) % num_instances_;
+  for (page_id_t page_id : disk_manager_->GetFreePages()) {
+    if (page_id % num_instances_ == instance_index_ && page_id < next_page_id_) {
+      free_page_ids_.insert(page_id);
+    }
+  }
 }
 
 BufferPoolManagerInstance::~BufferPoolManagerInstance() {
-  delete[] pages_;
+  StopPageCleaner();
+  {
+    std::scoped_lock prefetch_latch(prefetch_latch_);
+    stop_prefetch_ = true;
+    prefetch_cv_.notify_all();
+  }
+  if (prefetch_thread_ != nullptr) {
+    prefetch_thread_->join();
+    delete prefetch_thread_;
+  }
+  // Let the write-backs still in flight finish before the frames and the book-keeping they use go away.
+  delete disk_scheduler_;
+  for (size_t i = 0; i < num_frames_; ++i) {
+    pages_[i].~Page();
+    frame_headers_[i].~FrameHeader();
+  }
+  ::operator delete[](pages_, std::align_val_t(alignof(Page)));
+  ::operator delete[](frame_headers_, std::align_val_t(CACHE_LINE_SIZE));
+  delete frame_arena_;
   delete replacer_;
 }
 
 bool BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) {
   // Make sure you call DiskManager::WritePage!
-  std::scoped_lock scoped_latch(latch_);
-  if (page_table_.find(page_id) == page_table_.end()) {
+  frame_id_t frame_id;
+  {
+    std::shared_lock shared_latch(latch_);
+    auto iter = page_table_.find(page_id);
+    if (iter == page_table_.end()) {
+      return false;
+    }
+    frame_id = iter->second;
+    HoldFrame(frame_id);
+  }
+  bool written;
+  bool success = FlushFrame(frame_id, &written);
+  ReleaseFrame(frame_id);
+  return success;
+}
+
+void BufferPoolManagerInstance::FlushAllPgsImp() {
+  // You can do it!
+  // Snapshot where the dirty pages are, in page id order. Frames beyond the pool size may still hold pages that a
+  // shrink has not drained yet.
+  std::vector<std::pair<page_id_t, frame_id_t>> dirty_pages;
+  {
+    std::shared_lock shared_latch(latch_);
+    for (size_t i = 0; i < num_frames_; ++i) {
+      if ((frame_headers_[i].page_id_ != INVALID_PAGE_ID) && (frame_headers_[i].is_dirty_)) {
+        dirty_pages.emplace_back(frame_headers_[i].page_id_, static_cast<frame_id_t>(i));
+      }
+    }
+  }
+  std::sort(dirty_pages.begin(), dirty_pages.end());
+
+  // Holding a frame keeps its page from being evicted and written back while we write it, but also keeps fetches from
+  // using the frame, so only a fraction of the pool is held at a time.
+  const size_t batch_size = std::clamp<size_t>(pool_size_ / 4, 1, FLUSH_BATCH_SIZE);
+  std::vector<std::pair<page_id_t, frame_id_t>> held_pages;
+  for (size_t batch_begin = 0; batch_begin < dirty_pages.size(); batch_begin += batch_size) {
+    size_t batch_end = std::min(batch_begin + batch_size, dirty_pages.size());
+    held_pages.clear();
+    {
+      std::shared_lock shared_latch(latch_);
+      for (size_t i = batch_begin; i < batch_end; ++i) {
+        // The page may have been evicted, and written back, since the snapshot.
+        if (frame_headers_[dirty_pages[i].second].page_id_ == dirty_pages[i].first) {
+          HoldFrame(dirty_pages[i].second);
+          held_pages.push_back(dirty_pages[i]);
+        }
+      }
+    }
+    // The disk scheduler merges the writes to consecutive pages into vectored writes.
+    std::vector<std::pair<page_id_t, const char *>> writes;
+    std::vector<frame_id_t> write_frames;
+    for (const auto &[page_id, frame_id] : held_pages) {
+      WaitForFrameIO(frame_id);
+      // Clear the flag before writing, so an unpin that dirties the page during the write is not lost.
+      if (frame_headers_[frame_id].is_dirty_.exchange(false)) {
+        writes.emplace_back(page_id, frame_arena_->GetFrame(frame_id));
+        write_frames.push_back(frame_id);
+      }
+    }
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::future<bool>> write_futures = disk_scheduler_->ScheduleWrites(writes);
+    for (size_t i = 0; i < write_futures.size(); ++i) {
+      if (!write_futures[i].get()) {
+        frame_headers_[write_frames[i]].is_dirty_ = true;
+      }
+      stats_.RecordWrite(std::chrono::steady_clock::now() - start);
+    }
+    stats_.Add(BufferPoolCounter::PAGE_WRITES, writes.size());
+    for (const auto &held_page : held_pages) {
+      ReleaseFrame(held_page.second);
+    }
+  }
+}
+
+bool BufferPoolManagerInstance::FlushFrame(frame_id_t frame_id, bool *written) {
+  // Our pin keeps the page in its frame while we write without the latch.
+  FrameHeader *header = frame_headers_ + frame_id;
+  *written = false;
+  // A frame whose read failed is not dirty, so there is nothing to write either way.
+  WaitForFrameIO(frame_id);
+  // Clear the flag before writing, so an unpin that dirties the page during the write is not lost.
+  if (!header->is_dirty_.exchange(false)) {
+    return true;
+  }
+  if (!WriteFrame(frame_id, header->page_id_)) {
+    header->is_dirty_ = true;
     return false;
   }
-  frame_id_t frame_id = page_table_[page_id];
-  Page *page = pages_ + frame_id;
-  if (page->IsDirty()) {
-    disk_manager_->WritePage(page_id, page->GetData());
-    page->is_dirty_ = false;
+  *written = true;
+  return true;
+}
+
+void BufferPoolManagerInstance::Prefetch(page_id_t page_id, size_t num_pages) {
+  std::scoped_lock prefetch_latch(prefetch_latch_);
+  for (page_id_t prefetch_page_id = page_id; prefetch_page_id < page_id + static_cast<page_id_t>(num_pages);
+       ++prefetch_page_id) {
+    // Reading a page that was never allocated would only fill a frame with garbage.
+    if (prefetch_page_id < 0 || prefetch_page_id >= next_page_id_ || prefetch_queue_.size() >= pool_size_) {
+      break;
+    }
+    if (prefetch_page_id % num_instances_ == instance_index_) {
+      prefetch_queue_.push_back(prefetch_page_id);
+    }
+  }
+  if (prefetch_queue_.empty()) {
+    return;
+  }
+  if (prefetch_thread_ == nullptr) {
+    prefetch_thread_ = new std::thread(&BufferPoolManagerInstance::PrefetchLoop, this);
+  }
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManagerInstance::PrefetchLoop() {
+  std::unique_lock prefetch_latch(prefetch_latch_);
+  while (true) {
+    prefetch_cv_.wait(prefetch_latch, [&] { return stop_prefetch_ || !prefetch_queue_.empty(); });
+    if (stop_prefetch_) {
+      return;
+    }
+    page_id_t page_id = prefetch_queue_.front();
+    prefetch_queue_.pop_front();
+    prefetch_latch.unlock();
+    PrefetchPage(page_id);
+    prefetch_latch.lock();
+  }
+}
+
+void BufferPoolManagerInstance::PrefetchPage(page_id_t page_id) {
+  {
+    std::shared_lock shared_latch(latch_);
+    // Pinning a resident page would only disturb its position in the replacer, and a free page holds nothing.
+    if (page_table_.find(page_id) != page_table_.end() || free_page_ids_.count(page_id) != 0 ||
+        draining_pages_.count(page_id) != 0) {
+      return;
+    }
+  }
+  // Going around FetchPgImp and UnpinPgImp keeps the read out of the hit ratio and out of the replacer's access
+  // history, so that the page does not look used before anyone has used it.
+  auto exclusive_latch = LatchExclusive();
+  frame_id_t frame_id;
+  if (page_table_.find(page_id) != page_table_.end() || free_page_ids_.count(page_id) != 0 ||
+      draining_pages_.count(page_id) != 0 || !LoadPage(page_id, &exclusive_latch, &frame_id)) {
+    return;
   }
+  auto shared_latch = LatchShared();
+  if (frame_headers_[frame_id].pin_count_.fetch_sub(1) == 1) {
+    replacer_->UnpinPrefetched(frame_id);
+  }
+}
+
+void BufferPoolManagerInstance::RunPageCleaner(double dirty_ratio, size_t write_budget) {
+  std::scoped_lock cleaner_latch(cleaner_latch_);
+  if (cleaner_thread_ != nullptr) {
+    return;
+  }
+  cleaner_dirty_ratio_ = dirty_ratio;
+  cleaner_write_budget_ = write_budget;
+  enable_page_cleaner_ = true;
+  cleaner_thread_ = new std::thread(&BufferPoolManagerInstance::PageCleanerLoop, this);
+}
+
+void BufferPoolManagerInstance::StopPageCleaner() {
+  {
+    std::scoped_lock cleaner_latch(cleaner_latch_);
+    if (cleaner_thread_ == nullptr) {
+      return;
+    }
+    enable_page_cleaner_ = false;
+    cleaner_cv_.notify_all();
+  }
+  cleaner_thread_->join();
+  delete cleaner_thread_;
+  cleaner_thread_ = nullptr;
+}
+
+void BufferPoolManagerInstance::PageCleanerLoop() {
+  std::unique_lock cleaner_latch(cleaner_latch_);
+  while (!cleaner_cv_.wait_for(cleaner_latch, page_cleaner_interval, [&] { return !enable_page_cleaner_; })) {
+    cleaner_latch.unlock();
+    CleanPages();
+    cleaner_latch.lock();
+  }
+}
+
+size_t BufferPoolManagerInstance::CleanPages() {
+  // Frames beyond a concurrent shrink are drained by Resize, so the cleaner only sweeps the pool as it is now.
+  const size_t pool_size = pool_size_;
+  size_t num_dirty = 0;
+  for (size_t i = 0; i < pool_size; ++i) {
+    if (frame_headers_[i].is_dirty_) {
+      ++num_dirty;
+    }
+  }
+  const auto target = static_cast<size_t>(cleaner_dirty_ratio_ * static_cast<double>(pool_size));
+  size_t num_written = 0;
+  // Sweep the frames like a clock hand, so successive rounds spread their writes over the whole pool.
+  for (size_t scanned = 0; scanned < pool_size && num_dirty > target && num_written < cleaner_write_budget_;
+       ++scanned) {
+    auto frame_id = static_cast<frame_id_t>(cleaner_hand_ % pool_size);
+    cleaner_hand_ = (frame_id + 1) % pool_size;
+    FrameHeader *header = frame_headers_ + frame_id;
+    {
+      std::shared_lock shared_latch(latch_);
+      // Pinned pages are in use and will not be victims soon, leave them to be written when they are unpinned.
+      if ((header->page_id_ == INVALID_PAGE_ID) || (!header->is_dirty_) || (header->pin_count_ > 0)) {
+        continue;
+      }
+      HoldFrame(frame_id);
+    }
+    bool written;
+    FlushFrame(frame_id, &written);
+    if (written) {
+      ++num_written;
+      --num_dirty;
+    }
+    ReleaseFrame(frame_id);
+  }
+  return num_written;
+}
+
+bool BufferPoolManagerInstance::Resize(size_t new_pool_size) {
+  if (new_pool_size == 0 || new_pool_size > max_pool_size_) {
+    return false;
+  }
+  std::scoped_lock resize_latch(resize_latch_);
+  const size_t old_pool_size = pool_size_;
+  if (new_pool_size >= old_pool_size) {
+    std::scoped_lock scoped_latch(latch_);
+    for (size_t i = old_pool_size; i < new_pool_size; ++i) {
+      if (i >= num_frames_) {
+        new (&frame_headers_[i]) FrameHeader();
+        new (&pages_[i]) Page(&frame_headers_[i], frame_arena_->GetFrame(static_cast<frame_id_t>(i)));
+        num_frames_ = i + 1;
+      }
+      free_list_.emplace_back(static_cast<frame_id_t>(i));
+    }
+    pool_size_ = new_pool_size;
+    return true;
+  }
+
+  // Evicts the page of an unpinned frame beyond the new pool size. Its id is in write_back_pages_ until the page is on
+  // disk, so that fetches of it read it back in only then.
+  std::vector<std::pair<frame_id_t, page_id_t>> write_backs;
+  auto evict = [&](frame_id_t frame_id) {
+    FrameHeader *header = frame_headers_ + frame_id;
+    std::scoped_lock io_latch(io_latch_);
+    if (header->is_dirty_.exchange(false)) {
+      stats_.Add(BufferPoolCounter::DIRTY_EVICTIONS);
+      write_backs.emplace_back(frame_id, header->page_id_);
+      write_back_pages_.insert(header->page_id_);
+    } else {
+      stats_.Add(BufferPoolCounter::CLEAN_EVICTIONS);
+      write_back_pages_.erase(header->page_id_);
+      io_cv_.notify_all();
+    }
+    header->page_id_ = INVALID_PAGE_ID;
+  };
+  // Lower the pool size, so that the frames beyond it are no longer handed out, and take their pages out of the page
+  // table, so that fetches no longer pin them. A page that is still pinned drains out of its frame once the pins
+  // already held on it are released.
+  {
+    std::scoped_lock scoped_latch(latch_);
+    pool_size_ = new_pool_size;
+    free_list_.remove_if([&](frame_id_t frame_id) { return static_cast<size_t>(frame_id) >= new_pool_size; });
+    for (size_t i = new_pool_size; i < old_pool_size; ++i) {
+      auto frame_id = static_cast<frame_id_t>(i);
+      FrameHeader *header = frame_headers_ + frame_id;
+      if (header->page_id_ == INVALID_PAGE_ID) {
+        continue;
+      }
+      replacer_->Remove(frame_id);
+      page_table_.erase(header->page_id_);
+      if (header->pin_count_ > 0) {
+        draining_pages_.emplace(header->page_id_, frame_id);
+        std::scoped_lock io_latch(io_latch_);
+        write_back_pages_.insert(header->page_id_);
+      } else {
+        evict(frame_id);
+      }
+    }
+  }
+  while (true) {
+    // Like evictions, the write-backs happen without the latch; fetches of these pages wait for them.
+    for (const auto &[frame_id, page_id] : write_backs) {
+      WriteBack(frame_id, page_id);
+    }
+    write_backs.clear();
+    {
+      std::scoped_lock scoped_latch(latch_);
+      for (auto iter = draining_pages_.begin(); iter != draining_pages_.end();) {
+        if (frame_headers_[iter->second].pin_count_ > 0) {
+          ++iter;
+          continue;
+        }
+        evict(iter->second);
+        iter = draining_pages_.erase(iter);
+      }
+      if (draining_pages_.empty() && write_backs.empty()) {
+        break;
+      }
+    }
+    if (write_backs.empty()) {
+      std::this_thread::sleep_for(page_cleaner_interval);
+    }
+  }
+  frame_arena_->Discard(static_cast<frame_id_t>(new_pool_size), old_pool_size - new_pool_size);
   return true;
 }
 
-void BufferPoolManagerInstance::FlushAllPgsImp() {
-  // You can do it!
-  std::scoped_lock scoped_latch(latch_);
-  for (size_t i = 0; i < pool_size_; ++i) {
-    Page *page = pages_ + i;
-    if ((page->GetPageId() != INVALID_PAGE_ID) && (page->IsDirty())) {
-      disk_manager_->WritePage(page->GetPageId(), page->GetData());
-      page->is_dirty_ = false;
+size_t BufferPoolManagerInstance::GetNumAvailableFrames() {
+  std::shared_lock shared_latch(latch_);
+  // The replacer may still hold a few frames that were pinned again, so this is an estimate under concurrency.
+  return free_list_.size() + replacer_->Size();
+}
+
+std::shared_lock<std::shared_mutex> BufferPoolManagerInstance::LatchShared() {
+  std::shared_lock shared_latch(latch_, std::try_to_lock);
+  // Only waiting is timed, so an uncontended acquisition costs no clock reads.
+  if (!shared_latch.owns_lock()) {
+    auto start = std::chrono::steady_clock::now();
+    shared_latch.lock();
+    stats_.Add(BufferPoolCounter::LATCH_WAITS);
+    stats_.Add(BufferPoolCounter::LATCH_WAIT_NS,
+               std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+  }
+  return shared_latch;
+}
+
+std::unique_lock<std::shared_mutex> BufferPoolManagerInstance::LatchExclusive() {
+  std::unique_lock exclusive_latch(latch_, std::try_to_lock);
+  if (!exclusive_latch.owns_lock()) {
+    auto start = std::chrono::steady_clock::now();
+    exclusive_latch.lock();
+    stats_.Add(BufferPoolCounter::LATCH_WAITS);
+    stats_.Add(BufferPoolCounter::LATCH_WAIT_NS,
+               std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+  }
+  return exclusive_latch;
+}
+
+Page *BufferPoolManagerInstance::PinFrame(frame_id_t frame_id) {
+  if (frame_headers_[frame_id].pin_count_.fetch_add(1) == 0) {
+    replacer_->Pin(frame_id);
+  }
+  return pages_ + frame_id;
+}
+
+void BufferPoolManagerInstance::HoldFrame(frame_id_t frame_id) { frame_headers_[frame_id].pin_count_.fetch_add(1); }
+
+void BufferPoolManagerInstance::ReleaseFrame(frame_id_t frame_id) {
+  std::shared_lock shared_latch(latch_);
+  // If the frame was unpinned before we held it, it is normally still in the replacer and Unpin leaves it where it
+  // was. If a victim search dropped it while we held it, this puts it back.
+  if (frame_headers_[frame_id].pin_count_.fetch_sub(1) == 1 && static_cast<size_t>(frame_id) < pool_size_) {
+    replacer_->Unpin(frame_id);
+  }
+}
+
+bool BufferPoolManagerInstance::FindReplacementFrame(frame_id_t *frame_id, page_id_t *write_back_page_id) {
+  *write_back_page_id = INVALID_PAGE_ID;
+  if (!free_list_.empty()) {
+    *frame_id = free_list_.front();
+    free_list_.pop_front();
+    return true;
+  }
+  // Pins and unpins race with each other under the shared latch, so the replacer may briefly hold a frame that has
+  // been pinned again. No one can pin while we hold the latch exclusively, so such frames are simply dropped here;
+  // they go back into the replacer when their pin count next drops to zero.
+  while (replacer_->Victim(frame_id)) {
+    FrameHeader *header = frame_headers_ + *frame_id;
+    // Frames beyond the pool size are left to Resize, which drains them.
+    if (header->pin_count_ > 0 || static_cast<size_t>(*frame_id) >= pool_size_) {
+      continue;
+    }
+    if (header->is_dirty_.exchange(false)) {
+      stats_.Add(BufferPoolCounter::DIRTY_EVICTIONS);
+      *write_back_page_id = header->page_id_;
+      std::scoped_lock io_latch(io_latch_);
+      write_back_pages_.insert(*write_back_page_id);
+    } else {
+      stats_.Add(BufferPoolCounter::CLEAN_EVICTIONS);
     }
+    page_table_.erase(header->page_id_);
+    return true;
+  }
+  return false;
+}
+
+bool BufferPoolManagerInstance::WriteFrame(frame_id_t frame_id, page_id_t page_id) {
+  auto start = std::chrono::steady_clock::now();
+  bool success = disk_scheduler_->ScheduleWrite(page_id, frame_arena_->GetFrame(frame_id)).get();
+  stats_.RecordWrite(std::chrono::steady_clock::now() - start);
+  stats_.Add(BufferPoolCounter::PAGE_WRITES);
+  return success;
+}
+
+bool BufferPoolManagerInstance::ReadFrame(frame_id_t frame_id, page_id_t page_id) {
+  auto start = std::chrono::steady_clock::now();
+  bool success = disk_scheduler_->ScheduleRead(page_id, frame_arena_->GetFrame(frame_id)).get();
+  stats_.RecordRead(std::chrono::steady_clock::now() - start);
+  return success;
+}
+
+void BufferPoolManagerInstance::WriteBack(frame_id_t frame_id, page_id_t page_id) {
+  std::shared_ptr<char[]> data(new char[PAGE_SIZE]);
+  memcpy(data.get(), frame_arena_->GetFrame(frame_id), PAGE_SIZE);
+  auto start = std::chrono::steady_clock::now();
+  disk_scheduler_->ScheduleWrite(page_id, data.get(), [this, page_id, data, start](bool success) {
+    stats_.RecordWrite(std::chrono::steady_clock::now() - start);
+    stats_.Add(BufferPoolCounter::PAGE_WRITES);
+    std::scoped_lock io_latch(io_latch_);
+    write_back_pages_.erase(page_id);
+    io_cv_.notify_all();
+  });
+}
+
+void BufferPoolManagerInstance::WaitForWriteBack(page_id_t page_id) {
+  std::unique_lock io_latch(io_latch_);
+  io_cv_.wait(io_latch, [&] { return write_back_pages_.count(page_id) == 0; });
+}
+
+bool BufferPoolManagerInstance::WaitForFrameIO(frame_id_t frame_id) {
+  FrameHeader *header = frame_headers_ + frame_id;
+  if (header->io_pending_) {
+    stats_.Add(BufferPoolCounter::PIN_WAITS);
+    std::unique_lock io_latch(io_latch_);
+    io_cv_.wait(io_latch, [&] { return !header->io_pending_; });
+  }
+  return !header->io_failed_;
+}
+
+void BufferPoolManagerInstance::FinishFrameIO(frame_id_t frame_id, bool success) {
+  std::scoped_lock io_latch(io_latch_);
+  frame_headers_[frame_id].io_failed_ = !success;
+  frame_headers_[frame_id].io_pending_ = false;
+  io_cv_.notify_all();
+}
+
+void BufferPoolManagerInstance::DropFailedFrame(frame_id_t frame_id) {
+  auto exclusive_latch = LatchExclusive();
+  FrameHeader *header = frame_headers_ + frame_id;
+  if (header->page_id_ != INVALID_PAGE_ID) {
+    page_table_.erase(header->page_id_);
+    header->page_id_ = INVALID_PAGE_ID;
+  }
+  // Frames beyond the pool size are left to Resize, which skips frames without a page.
+  if (header->pin_count_.fetch_sub(1) == 1 && static_cast<size_t>(frame_id) < pool_size_) {
+    replacer_->Remove(frame_id);
+    free_list_.push_back(frame_id);
   }
 }
 
@@ -80,30 +569,28 @@ Page *BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) {
   // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
   // 3.   Update P's metadata, zero out memory and add P to the page table.
   // 4.   Set the page ID output parameter. Return a pointer to P.
-  std::scoped_lock scoped_latch(latch_);
-  if (free_list_.empty() && (replacer_->Size() == 0)) {
-    return nullptr;
-  }
+  auto exclusive_latch = LatchExclusive();
   frame_id_t frame_id;
-  Page *page;
-  if (!free_list_.empty()) {
-    frame_id = free_list_.front();
-    free_list_.pop_front();
-    page = &pages_[frame_id];
-  } else {
-    replacer_->Victim(&frame_id);
-    page = &pages_[frame_id];
-    if (page->IsDirty()) {
-      disk_manager_->WritePage(page->GetPageId(), page->GetData());
-      page->is_dirty_ = false;
-    }
-    page_table_.erase(page->GetPageId());
+  page_id_t write_back_page_id;
+  if (!FindReplacementFrame(&frame_id, &write_back_page_id)) {
+    return nullptr;
   }
+  Page *page = pages_ + frame_id;
+  FrameHeader *header = frame_headers_ + frame_id;
   page_id_t allocated_page_id = AllocatePage();
-  page->ResetMemory();
-  page->page_id_ = allocated_page_id;
-  page->pin_count_ = 1;
+  header->page_id_ = allocated_page_id;
+  header->pin_count_ = 1;
+  header->io_pending_ = true;
   page_table_.insert(std::make_pair(allocated_page_id, frame_id));
+  exclusive_latch.unlock();
+
+  if (write_back_page_id != INVALID_PAGE_ID) {
+    WriteBack(frame_id, write_back_page_id);
+  }
+  // A reused page id may still have its old contents on the way out, which must not land after the new page's.
+  WaitForWriteBack(allocated_page_id);
+  page->ResetMemory();
+  FinishFrameIO(frame_id, true);
   *page_id = allocated_page_id;
   return page;
 }
@@ -116,39 +603,193 @@ Page *BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) {
   // 2.     If R is dirty, write it back to the disk.
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
-  std::scoped_lock scoped_latch(latch_);
-  frame_id_t frame_id{0};
-  Page *page;
-  if (page_table_.find(page_id) != page_table_.end()) {
-    frame_id = page_table_[page_id];
-    page = pages_ + frame_id;
-    if (page->GetPinCount() == 0) {
-      replacer_->Pin(frame_id);
-    }
-    page->pin_count_++;
+  Page *page = nullptr;
+  frame_id_t frame_id;
+  {
+    auto shared_latch = LatchShared();
+    auto iter = page_table_.find(page_id);
+    if (iter != page_table_.end()) {
+      frame_id = iter->second;
+      page = PinFrame(frame_id);
+    }
+  }
+  if (page != nullptr) {
+    stats_.Add(BufferPoolCounter::HITS);
+    // P may still be on its way in from disk, and may not make it.
+    if (!WaitForFrameIO(frame_id)) {
+      DropFailedFrame(frame_id);
+      return nullptr;
+    }
+    return page;
+  }
+
+  auto exclusive_latch = LatchExclusive();
+  auto iter = page_table_.find(page_id);
+  bool is_draining = iter == page_table_.end() && WaitForDrain(page_id, &exclusive_latch, &frame_id);
+  if (!is_draining) {
+    iter = page_table_.find(page_id);
+  }
+  // Another thread may have brought P in while we were waiting for the exclusive latch.
+  if (is_draining || iter != page_table_.end()) {
+    if (!is_draining) {
+      frame_id = iter->second;
+    }
+    page = PinFrame(frame_id);
+    exclusive_latch.unlock();
+    stats_.Add(BufferPoolCounter::HITS);
+    if (!WaitForFrameIO(frame_id)) {
+      DropFailedFrame(frame_id);
+      return nullptr;
+    }
     return page;
   }
-  if ((free_list_.empty()) && (replacer_->Size() == 0)) {
+  stats_.Add(BufferPoolCounter::MISSES);
+  if (!LoadPage(page_id, &exclusive_latch, &frame_id)) {
     return nullptr;
   }
-  if (free_list_.empty()) {
-    replacer_->Victim(&frame_id);
-    page = pages_ + frame_id;
-    if (page->IsDirty()) {
-      disk_manager_->WritePage(page->GetPageId(), page->GetData());
-      page->is_dirty_ = false;
+  return pages_ + frame_id;
+}
+
+bool BufferPoolManagerInstance::WaitForDrain(page_id_t page_id, std::unique_lock<std::shared_mutex> *exclusive_latch,
+                                             frame_id_t *frame_id) {
+  if (draining_pages_.count(page_id) == 0) {
+    return false;
+  }
+  exclusive_latch->unlock();
+  {
+    std::unique_lock io_latch(io_latch_);
+    io_cv_.wait_for(io_latch, 2 * page_cleaner_interval, [&] { return write_back_pages_.count(page_id) == 0; });
+  }
+  exclusive_latch->lock();
+  auto iter = draining_pages_.find(page_id);
+  if (iter == draining_pages_.end()) {
+    return false;
+  }
+  *frame_id = iter->second;
+  return true;
+}
+
+bool BufferPoolManagerInstance::LoadPage(page_id_t page_id, std::unique_lock<std::shared_mutex> *exclusive_latch,
+                                         frame_id_t *frame_id) {
+  page_id_t write_back_page_id;
+  if (!FindReplacementFrame(frame_id, &write_back_page_id)) {
+    return false;
+  }
+  FrameHeader *header = frame_headers_ + *frame_id;
+  page_table_.insert(std::make_pair(page_id, *frame_id));
+  header->page_id_ = page_id;
+  header->pin_count_ = 1;
+  header->io_pending_ = true;
+  exclusive_latch->unlock();
+
+  // Threads asking for the page now find it in the page table and wait on this frame, everyone else carries on.
+  if (write_back_page_id != INVALID_PAGE_ID) {
+    WriteBack(*frame_id, write_back_page_id);
+  }
+  WaitForWriteBack(page_id);
+  bool success = ReadFrame(*frame_id, page_id);
+  FinishFrameIO(*frame_id, success);
+  if (!success) {
+    DropFailedFrame(*frame_id);
+    return false;
+  }
+  return true;
+}
+
+size_t BufferPoolManagerInstance::FetchPages(const std::vector<page_id_t> &page_ids, Page **pages) {
+  std::vector<size_t> misses;
+  std::vector<size_t> draining_misses;
+  size_t num_hits = 0;
+  {
+    auto shared_latch = LatchShared();
+    for (size_t i = 0; i < page_ids.size(); ++i) {
+      auto iter = page_table_.find(page_ids[i]);
+      if (iter != page_table_.end()) {
+        pages[i] = PinFrame(iter->second);
+        ++num_hits;
+      } else {
+        pages[i] = nullptr;
+        misses.push_back(i);
+      }
     }
-    page_table_.erase(page->GetPageId());
-  } else {
-    frame_id = free_list_.front();
-    free_list_.pop_front();
-    page = pages_ + frame_id;
   }
-  page_table_.insert(std::make_pair(page_id, frame_id));
-  page->page_id_ = page_id;
-  page->pin_count_ = 1;
-  disk_manager_->ReadPage(page_id, page->GetData());
-  return page;
+
+  // Claim a frame for every miss under one exclusive acquisition, then do all the I/O without the latch.
+  std::vector<std::pair<frame_id_t, page_id_t>> write_backs;
+  std::vector<std::pair<page_id_t, char *>> reads;
+  std::vector<frame_id_t> read_frames;
+  if (!misses.empty()) {
+    auto exclusive_latch = LatchExclusive();
+    for (size_t i : misses) {
+      // The page may have been brought in meanwhile, possibly by an earlier miss in this very batch.
+      auto iter = page_table_.find(page_ids[i]);
+      if (iter != page_table_.end()) {
+        pages[i] = PinFrame(iter->second);
+        ++num_hits;
+        continue;
+      }
+      // Pages that are draining out of frames that Resize removes are left to FetchPgImp, which waits for them.
+      if (draining_pages_.count(page_ids[i]) != 0) {
+        draining_misses.push_back(i);
+        continue;
+      }
+      frame_id_t frame_id;
+      page_id_t write_back_page_id;
+      if (!FindReplacementFrame(&frame_id, &write_back_page_id)) {
+        continue;
+      }
+      FrameHeader *header = frame_headers_ + frame_id;
+      page_table_.insert(std::make_pair(page_ids[i], frame_id));
+      header->page_id_ = page_ids[i];
+      header->pin_count_ = 1;
+      header->io_pending_ = true;
+      pages[i] = pages_ + frame_id;
+      if (write_back_page_id != INVALID_PAGE_ID) {
+        write_backs.emplace_back(frame_id, write_back_page_id);
+      }
+      reads.emplace_back(page_ids[i], frame_arena_->GetFrame(frame_id));
+      read_frames.push_back(frame_id);
+    }
+  }
+
+  for (const auto &[frame_id, write_back_page_id] : write_backs) {
+    WriteBack(frame_id, write_back_page_id);
+  }
+  for (const auto &read : reads) {
+    WaitForWriteBack(read.first);
+  }
+  // The disk scheduler sorts the reads and submits them together.
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::future<bool>> read_futures;
+  for (const auto &[page_id, data] : reads) {
+    read_futures.push_back(disk_scheduler_->ScheduleRead(page_id, data));
+  }
+  for (size_t i = 0; i < read_futures.size(); ++i) {
+    bool success = read_futures[i].get();
+    stats_.RecordRead(std::chrono::steady_clock::now() - start);
+    FinishFrameIO(read_frames[i], success);
+  }
+  for (size_t i : draining_misses) {
+    pages[i] = FetchPgImp(page_ids[i]);
+  }
+
+  // Hits may still be on their way in from disk, read by other threads. Pages that could not be read are not fetched.
+  size_t num_fetched = 0;
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    if (pages[i] == nullptr) {
+      continue;
+    }
+    auto frame_id = static_cast<frame_id_t>(pages[i] - pages_);
+    if (!WaitForFrameIO(frame_id)) {
+      DropFailedFrame(frame_id);
+      pages[i] = nullptr;
+      continue;
+    }
+    ++num_fetched;
+  }
+  stats_.Add(BufferPoolCounter::HITS, num_hits);
+  stats_.Add(BufferPoolCounter::MISSES, page_ids.size() - num_hits - draining_misses.size());
+  return num_fetched;
 }
 
 bool BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) {
@@ -157,55 +798,102 @@ bool BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) {
   // 1.   If P does not exist, return true.
   // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
-  std::scoped_lock scoped_latch(latch_);
-  if (page_table_.find(page_id) == page_table_.end()) {
+  auto exclusive_latch = LatchExclusive();
+  auto iter = page_table_.find(page_id);
+  if (iter == page_table_.end()) {
+    // A page draining out of a frame that Resize removes is still pinned.
+    if (draining_pages_.count(page_id) != 0) {
+      return false;
+    }
+    DeallocatePage(page_id);
     return true;
   }
-  frame_id_t frame_id = page_table_[page_id];
-  Page *page = pages_ + frame_id;
-  if (page->GetPinCount() > 0) {
+  frame_id_t frame_id = iter->second;
+  FrameHeader *header = frame_headers_ + frame_id;
+  if (header->pin_count_ > 0) {
     return false;
   }
-  if (page->IsDirty()) {
-    disk_manager_->WritePage(page->GetPageId(), page->GetData());
-    page->is_dirty_ = false;
-  }
-  page_table_.erase(page_id);
-  replacer_->Pin(frame_id);
+  // The page is gone, so there is no point in writing out its contents.
+  page_table_.erase(iter);
+  replacer_->Remove(frame_id);
   DeallocatePage(page_id);
-  page->page_id_ = INVALID_PAGE_ID;
-  page->pin_count_ = 0;
-  free_list_.push_back(frame_id);
+  header->page_id_ = INVALID_PAGE_ID;
+  header->pin_count_ = 0;
+  header->is_dirty_ = false;
+  if (static_cast<size_t>(frame_id) < pool_size_) {
+    free_list_.push_back(frame_id);
+  }
   return true;
 }
 
 bool BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) {
-  std::scoped_lock scoped_latch(latch_);
-  if (page_table_.find(page_id) == page_table_.end()) {
-    return true;
+  auto shared_latch = LatchShared();
+  return UnpinFrame(page_id, is_dirty);
+}
+
+bool BufferPoolManagerInstance::UnpinPages(const std::vector<page_id_t> &page_ids, bool is_dirty) {
+  auto shared_latch = LatchShared();
+  bool unpinned = true;
+  for (page_id_t page_id : page_ids) {
+    unpinned = UnpinFrame(page_id, is_dirty) && unpinned;
+  }
+  return unpinned;
+}
+
+bool BufferPoolManagerInstance::UnpinFrame(page_id_t page_id, bool is_dirty) {
+  auto iter = page_table_.find(page_id);
+  if (iter == page_table_.end()) {
+    iter = draining_pages_.find(page_id);
+    if (iter == draining_pages_.end()) {
+      return true;
+    }
   }
-  frame_id_t frame_id = page_table_[page_id];
-  Page *page = &pages_[frame_id];
-  if (page->GetPinCount() <= 0) {
+  frame_id_t frame_id = iter->second;
+  FrameHeader *header = frame_headers_ + frame_id;
+  int pin_count = header->pin_count_;
+  if (pin_count <= 0) {
     return false;
   }
+  // Mark the page dirty while we still hold our pin, otherwise it could be evicted clean in between.
   if (is_dirty) {
-    page->is_dirty_ = is_dirty;
+    header->is_dirty_ = true;
+  }
+  while (!header->pin_count_.compare_exchange_weak(pin_count, pin_count - 1)) {
+    if (pin_count <= 0) {
+      return false;
+    }
   }
-  page->pin_count_--;
-  if (page->pin_count_ == 0) {
+  // A frame beyond the pool size is draining, and Resize evicts its page rather than the replacer.
+  if (pin_count == 1 && static_cast<size_t>(frame_id) < pool_size_) {
     replacer_->Unpin(frame_id);
   }
   return true;
 }
 
 page_id_t BufferPoolManagerInstance::AllocatePage() {
+  for (auto iter = free_page_ids_.begin(); iter != free_page_ids_.end(); ++iter) {
+    // A deleted page that was fetched again still has a frame, and reusing its id would map the id twice.
+    if (page_table_.find(*iter) == page_table_.end()) {
+      const page_id_t page_id = *iter;
+      free_page_ids_.erase(iter);
+      disk_manager_->ReusePage(page_id);
+      return page_id;
+    }
+  }
   const page_id_t next_page_id = next_page_id_;
   next_page_id_ += num_instances_;
   ValidatePageId(next_page_id);
   return next_page_id;
 }
 
+void BufferPoolManagerInstance::DeallocatePage(page_id_t page_id) {
+  // Deleting a page that was never allocated, or is already free, must not hand it out later.
+  if (page_id < 0 || page_id >= next_page_id_ || !free_page_ids_.insert(page_id).second) {
+    return;
+  }
+  disk_manager_->DeallocatePage(page_id);
+}
+
 void BufferPoolManagerInstance::ValidatePageId(const page_id_t page_id) const {
   assert(page_id % num_instances_ == instance_index_);  // allocated pages mod back to this BPI
 }
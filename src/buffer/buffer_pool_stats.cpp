@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.cpp
+//
+// Identification: src/buffer/buffer_pool_stats.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_stats.h"
+
+namespace bustub {
+
+BufferPoolStats &BufferPoolStats::operator+=(const BufferPoolStats &other) {
+  hits_ += other.hits_;
+  misses_ += other.misses_;
+  clean_evictions_ += other.clean_evictions_;
+  dirty_evictions_ += other.dirty_evictions_;
+  page_writes_ += other.page_writes_;
+  pin_waits_ += other.pin_waits_;
+  latch_waits_ += other.latch_waits_;
+  latch_wait_ns_ += other.latch_wait_ns_;
+  for (size_t i = 0; i < NUM_LATENCY_BUCKETS; ++i) {
+    read_latency_[i] += other.read_latency_[i];
+    write_latency_[i] += other.write_latency_[i];
+  }
+  return *this;
+}
+
+size_t BufferPoolStats::LatencyBucket(std::chrono::nanoseconds latency) {
+  auto micros = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+  size_t bucket = 0;
+  while (micros > 1 && bucket < NUM_LATENCY_BUCKETS - 1) {
+    micros >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+uint64_t BufferPoolStatsCollector::Get(BufferPoolCounter counter) const {
+  uint64_t value = 0;
+  for (const auto &shard : shards_) {
+    value += shard.counters_[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+  }
+  return value;
+}
+
+BufferPoolStats BufferPoolStatsCollector::Collect() const {
+  BufferPoolStats stats;
+  stats.hits_ = Get(BufferPoolCounter::HITS);
+  stats.misses_ = Get(BufferPoolCounter::MISSES);
+  stats.clean_evictions_ = Get(BufferPoolCounter::CLEAN_EVICTIONS);
+  stats.dirty_evictions_ = Get(BufferPoolCounter::DIRTY_EVICTIONS);
+  stats.page_writes_ = Get(BufferPoolCounter::PAGE_WRITES);
+  stats.pin_waits_ = Get(BufferPoolCounter::PIN_WAITS);
+  stats.latch_waits_ = Get(BufferPoolCounter::LATCH_WAITS);
+  stats.latch_wait_ns_ = Get(BufferPoolCounter::LATCH_WAIT_NS);
+  for (const auto &shard : shards_) {
+    for (size_t i = 0; i < BufferPoolStats::NUM_LATENCY_BUCKETS; ++i) {
+      stats.read_latency_[i] += shard.read_latency_[i].load(std::memory_order_relaxed);
+      stats.write_latency_[i] += shard.write_latency_[i].load(std::memory_order_relaxed);
+    }
+  }
+  return stats;
+}
+
+size_t BufferPoolStatsCollector::ShardIndex() {
+  static std::atomic<size_t> next_shard{0};
+  thread_local size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % NUM_SHARDS;
+  return shard;
+}
+
+}  // namespace bustub
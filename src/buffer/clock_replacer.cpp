@@ -14,16 +14,59 @@
 
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages) : num_pages_(num_pages), frame_states_(num_pages) {}
 
 ClockReplacer::~ClockReplacer() = default;
 
-bool ClockReplacer::Victim(frame_id_t *frame_id) { return false; }
+bool ClockReplacer::Victim(frame_id_t *frame_id) {
+  while (size_.load() > 0) {
+    size_t frame = clock_hand_.fetch_add(1) % num_pages_;
+    uint8_t state = frame_states_[frame].load();
+    if ((state & IN_REPLACER) == 0) {
+      continue;
+    }
+    if ((state & REFERENCED) != 0) {
+      // Second chance. If the frame was pinned or unpinned meanwhile, the hand will come back to it.
+      frame_states_[frame].compare_exchange_strong(state, IN_REPLACER);
+      continue;
+    }
+    if (frame_states_[frame].compare_exchange_strong(state, 0)) {
+      size_.fetch_sub(1);
+      *frame_id = static_cast<frame_id_t>(frame);
+      return true;
+    }
+  }
+  return false;
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::Pin(frame_id_t frame_id) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_) {
+    return;
+  }
+  if ((frame_states_[frame_id].exchange(0) & IN_REPLACER) != 0) {
+    size_.fetch_sub(1);
+  }
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_) {
+    return;
+  }
+  if ((frame_states_[frame_id].fetch_or(IN_REPLACER | REFERENCED) & IN_REPLACER) == 0) {
+    size_.fetch_add(1);
+  }
+}
 
-size_t ClockReplacer::Size() { return 0; }
+void ClockReplacer::UnpinPrefetched(frame_id_t frame_id) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_) {
+    return;
+  }
+  // Without the reference bit, the page gets no second chance until it is actually used.
+  if ((frame_states_[frame_id].fetch_or(IN_REPLACER) & IN_REPLACER) == 0) {
+    size_.fetch_add(1);
+  }
+}
+
+size_t ClockReplacer::Size() { return size_.load(); }
 
 }  // namespace bustub
@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+
+#ifdef BUSTUB_HAVE_NUMA
+#include <numa.h>
+#include <numaif.h>
+#endif
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+FrameArena::FrameArena(size_t num_frames, bool use_huge_pages, int numa_node) {
+  size_t size = num_frames * PAGE_SIZE;
+  mapping_size_ = size;
+  void *mapping = MAP_FAILED;
+  if (use_huge_pages) {
+    // Preallocated huge pages need a length that is a multiple of the huge page size.
+    mapping_size_ = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    mapping = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    huge_pages_ = mapping != MAP_FAILED;
+    if (mapping == MAP_FAILED) {
+      // Fall back to transparent huge pages, which only back huge-page-aligned ranges, so leave room to align.
+      mapping_size_ = size + HUGE_PAGE_SIZE;
+    }
+  }
+  if (mapping == MAP_FAILED) {
+    mapping = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  }
+  if (mapping == MAP_FAILED) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "can't map buffer pool frames");
+  }
+  mapping_ = static_cast<char *>(mapping);
+  data_ = mapping_;
+  if (use_huge_pages && !huge_pages_) {
+    auto address = reinterpret_cast<uintptr_t>(mapping_);
+    data_ = reinterpret_cast<char *>((address + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE);
+    huge_pages_ = madvise(data_, size, MADV_HUGEPAGE) == 0;
+    if (!huge_pages_) {
+      LOG_DEBUG("huge pages are not available, buffer pool frames use regular pages");
+    }
+  }
+
+#ifdef BUSTUB_HAVE_NUMA
+  if (numa_node >= 0 && numa_available() >= 0 && numa_max_node() > 0) {
+    int node = numa_node % (numa_max_node() + 1);
+    struct bitmask *nodes = numa_allocate_nodemask();
+    numa_bitmask_setbit(nodes, node);
+    // Preferred rather than bound, so that frames still get memory if the node runs out.
+    if (mbind(mapping_, mapping_size_, MPOL_PREFERRED, nodes->maskp, nodes->size + 1, 0) == 0) {
+      numa_node_ = node;
+    }
+    numa_free_nodemask(nodes);
+  }
+#endif
+}
+
+FrameArena::~FrameArena() { munmap(mapping_, mapping_size_); }
+
+void FrameArena::Discard(frame_id_t frame_id, size_t num_frames) {
+  auto begin = reinterpret_cast<uintptr_t>(GetFrame(frame_id));
+  auto end = begin + num_frames * PAGE_SIZE;
+  if (huge_pages_) {
+    begin = (begin + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    end = end / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+  }
+  // The memory is only advice to give back, so a failure just leaves it in place.
+  if (begin < end && madvise(reinterpret_cast<void *>(begin), end - begin, MADV_DONTNEED) != 0) {
+    LOG_DEBUG("can't discard buffer pool frames");
+  }
+}
+
+}  // namespace bustub
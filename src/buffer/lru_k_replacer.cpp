@@ -0,0 +1,112 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.cpp
+//
+// Identification: src/buffer/lru_k_replacer.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k) : num_pages_(num_pages), k_(k), frame_histories_(num_pages) {
+  BUSTUB_ASSERT(k > 0, "LRU-K needs to remember at least one access per frame");
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+std::set<std::pair<uint64_t, frame_id_t>> *LRUKReplacer::EvictableSet(const FrameHistory &history) {
+  return history.accesses_.size() < k_ ? &history_frames_ : &cache_frames_;
+}
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  std::scoped_lock scoped_lru_k_replacer_latch(lru_k_replacer_latch_);
+  auto *victims = history_frames_.empty() ? &cache_frames_ : &history_frames_;
+  if (victims->empty()) {
+    return false;
+  }
+  *frame_id = victims->begin()->second;
+  victims->erase(victims->begin());
+  // The frame is about to hold a different page, whose history starts from scratch. If the buffer pool finds the frame
+  // pinned again and keeps it, its page starts over as well, which only makes it look cold for its next k accesses.
+  frame_histories_[*frame_id] = FrameHistory();
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  std::scoped_lock scoped_lru_k_replacer_latch(lru_k_replacer_latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_) {
+    return;
+  }
+  FrameHistory &history = frame_histories_[frame_id];
+  if (history.evictable_) {
+    EvictableSet(history)->erase({history.accesses_.front(), frame_id});
+    history.evictable_ = false;
+  }
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  std::scoped_lock scoped_lru_k_replacer_latch(lru_k_replacer_latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_) {
+    return;
+  }
+  FrameHistory &history = frame_histories_[frame_id];
+  if (history.evictable_) {
+    return;
+  }
+  if (history.prefetched_) {
+    history.accesses_.clear();
+    history.prefetched_ = false;
+  }
+  history.accesses_.push_back(current_timestamp_++);
+  if (history.accesses_.size() > k_) {
+    history.accesses_.pop_front();
+  }
+  EvictableSet(history)->emplace(history.accesses_.front(), frame_id);
+  history.evictable_ = true;
+}
+
+void LRUKReplacer::UnpinPrefetched(frame_id_t frame_id) {
+  std::scoped_lock scoped_lru_k_replacer_latch(lru_k_replacer_latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_) {
+    return;
+  }
+  FrameHistory &history = frame_histories_[frame_id];
+  if (history.evictable_) {
+    return;
+  }
+  // A fresh frame needs a place among the frames with fewer than K accesses, so it gets one that does not count.
+  if (history.accesses_.empty()) {
+    history.accesses_.push_back(current_timestamp_++);
+    history.prefetched_ = true;
+  }
+  EvictableSet(history)->emplace(history.accesses_.front(), frame_id);
+  history.evictable_ = true;
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock scoped_lru_k_replacer_latch(lru_k_replacer_latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_pages_) {
+    return;
+  }
+  FrameHistory &history = frame_histories_[frame_id];
+  if (history.evictable_) {
+    EvictableSet(history)->erase({history.accesses_.front(), frame_id});
+  }
+  // The frame is about to hold a different page, whose history starts from scratch.
+  history = FrameHistory();
+}
+
+size_t LRUKReplacer::Size() {
+  std::scoped_lock scoped_lru_k_replacer_latch(lru_k_replacer_latch_);
+  return history_frames_.size() + cache_frames_.size();
+}
+
+}  // namespace bustub
@@ -12,33 +12,136 @@
 
 #include "buffer/parallel_buffer_pool_manager.h"
 
+#include <algorithm>
+#include <functional>
+#include <thread>  // NOLINT
+#include <utility>
+
 namespace bustub {
 
 ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
-                                                     LogManager *log_manager)
+                                                     LogManager *log_manager, ReplacerType replacer_type,
+                                                     bool use_huge_pages, size_t max_pool_size)
     : num_instances_(static_cast<uint32_t>(num_instances)),
       pool_size_(pool_size),
       disk_manager_(disk_manager),
       log_manager_(log_manager) {
-  allocate_index_ = 0;
   // Allocate and create individual BufferPoolManagerInstances
   bpms_ = new BufferPoolManagerInstance *[num_instances_];
   for (uint32_t i = 0; i < num_instances; ++i) {
-    bpms_[i] = new BufferPoolManagerInstance(pool_size, num_instances_, i, disk_manager_, log_manager_);
+    bpms_[i] = new BufferPoolManagerInstance(pool_size, num_instances_, i, disk_manager_, log_manager_, replacer_type,
+                                             use_huge_pages, max_pool_size);
   }
 }
 
 // Update constructor to destruct all BufferPoolManagerInstances and deallocate any associated memory
 ParallelBufferPoolManager::~ParallelBufferPoolManager() {
   for (uint32_t i = 0; i < num_instances_; ++i) {
-    free(bpms_[i]);
+    delete bpms_[i];
   }
-  free(bpms_);
+  delete[] bpms_;
 }
 
 size_t ParallelBufferPoolManager::GetPoolSize() {
   // Get size of all BufferPoolManagerInstances
-  return pool_size_ * static_cast<size_t>(num_instances_);
+  size_t pool_size = 0;
+  for (uint32_t i = 0; i < num_instances_; ++i) {
+    pool_size += bpms_[i]->GetPoolSize();
+  }
+  return pool_size;
+}
+
+bool ParallelBufferPoolManager::Resize(size_t new_pool_size) {
+  std::vector<size_t> instance_pool_sizes(num_instances_, new_pool_size / num_instances_);
+  for (uint32_t i = 0; i < new_pool_size % num_instances_; ++i) {
+    ++instance_pool_sizes[i];
+  }
+  // Check every instance before resizing any of them, so that a bad size leaves the pool as it was.
+  if (instance_pool_sizes.back() == 0 || instance_pool_sizes.front() > bpms_[0]->GetMaxPoolSize()) {
+    return false;
+  }
+  for (uint32_t i = 0; i < num_instances_; ++i) {
+    bpms_[i]->Resize(instance_pool_sizes[i]);
+  }
+  return true;
+}
+
+void ParallelBufferPoolManager::Prefetch(page_id_t page_id, size_t num_pages) {
+  for (uint32_t i = 0; i < num_instances_; ++i) {
+    bpms_[i]->Prefetch(page_id, num_pages);
+  }
+}
+
+size_t ParallelBufferPoolManager::FetchPages(const std::vector<page_id_t> &page_ids, Page **pages) {
+  std::vector<std::vector<page_id_t>> instance_page_ids(num_instances_);
+  std::vector<std::vector<size_t>> instance_positions(num_instances_);
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    instance_page_ids[page_ids[i] % num_instances_].push_back(page_ids[i]);
+    instance_positions[page_ids[i] % num_instances_].push_back(i);
+  }
+  size_t num_fetched = 0;
+  std::vector<Page *> instance_pages;
+  for (uint32_t i = 0; i < num_instances_; ++i) {
+    if (instance_page_ids[i].empty()) {
+      continue;
+    }
+    instance_pages.resize(instance_page_ids[i].size());
+    num_fetched += bpms_[i]->FetchPages(instance_page_ids[i], instance_pages.data());
+    for (size_t j = 0; j < instance_pages.size(); ++j) {
+      pages[instance_positions[i][j]] = instance_pages[j];
+    }
+  }
+  return num_fetched;
+}
+
+bool ParallelBufferPoolManager::UnpinPages(const std::vector<page_id_t> &page_ids, bool is_dirty) {
+  std::vector<std::vector<page_id_t>> instance_page_ids(num_instances_);
+  for (page_id_t page_id : page_ids) {
+    instance_page_ids[page_id % num_instances_].push_back(page_id);
+  }
+  bool unpinned = true;
+  for (uint32_t i = 0; i < num_instances_; ++i) {
+    if (!instance_page_ids[i].empty()) {
+      unpinned = bpms_[i]->UnpinPages(instance_page_ids[i], is_dirty) && unpinned;
+    }
+  }
+  return unpinned;
+}
+
+void ParallelBufferPoolManager::RunPageCleaner(double dirty_ratio, size_t write_budget) {
+  for (uint32_t i = 0; i < num_instances_; ++i) {
+    bpms_[i]->RunPageCleaner(dirty_ratio, write_budget);
+  }
+}
+
+void ParallelBufferPoolManager::StopPageCleaner() {
+  for (uint32_t i = 0; i < num_instances_; ++i) {
+    bpms_[i]->StopPageCleaner();
+  }
+}
+
+uint64_t ParallelBufferPoolManager::GetCleanEvictions() const {
+  uint64_t clean_evictions = 0;
+  for (uint32_t i = 0; i < num_instances_; ++i) {
+    clean_evictions += bpms_[i]->GetCleanEvictions();
+  }
+  return clean_evictions;
+}
+
+uint64_t ParallelBufferPoolManager::GetDirtyEvictions() const {
+  uint64_t dirty_evictions = 0;
+  for (uint32_t i = 0; i < num_instances_; ++i) {
+    dirty_evictions += bpms_[i]->GetDirtyEvictions();
+  }
+  return dirty_evictions;
+}
+
+BufferPoolStats ParallelBufferPoolManager::GetStats() {
+  BufferPoolStats stats;
+  for (uint32_t i = 0; i < num_instances_; ++i) {
+    stats += bpms_[i]->GetStats();
+  }
+  return stats;
 }
 
 BufferPoolManager *ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) {
@@ -65,30 +168,52 @@ bool ParallelBufferPoolManager::FlushPgImp(page_id_t page_id) {
 }
 
 Page *ParallelBufferPoolManager::NewPgImp(page_id_t *page_id) {
-  // create new page. We will request page allocation in a round robin manner from the underlying
-  // BufferPoolManagerInstances
-  // 1.   From a starting index of the BPMIs, call NewPageImpl until either 1) success and return 2) looped around to
-  // starting index and return nullptr
-  // 2.   Bump the starting index (mod number of instances) to start search at a different BPMI each time this function
-  // is called
-  std::scoped_lock scoped_latch(latch_);
-  uint32_t start_allocate_index = allocate_index_;
-  Page *page;
-  if ((page = bpms_[allocate_index_]->NewPage(page_id)) != nullptr) {
-    allocate_index_ = (allocate_index_ + 1) % num_instances_;
+  // create new page. We will request page allocation from the instance PickAllocateInstance prefers, and if that one
+  // is full, from the other instances in order of how many frames they have to spare.
+  uint32_t index = PickAllocateInstance();
+  Page *page = bpms_[index]->NewPage(page_id);
+  if (page != nullptr) {
     return page;
   }
-  allocate_index_ = (allocate_index_ + 1) % num_instances_;
-  while (allocate_index_ != start_allocate_index) {
-    if ((page = bpms_[allocate_index_]->NewPage(page_id)) != nullptr) {
-      allocate_index_ = (allocate_index_ + 1) % num_instances_;
+  std::vector<std::pair<size_t, uint32_t>> candidates;
+  for (uint32_t i = 0; i < num_instances_; ++i) {
+    if (i != index) {
+      candidates.emplace_back(bpms_[i]->GetNumAvailableFrames(), i);
+    }
+  }
+  std::sort(candidates.begin(), candidates.end(), std::greater<>());
+  for (const auto &candidate : candidates) {
+    if ((page = bpms_[candidate.second]->NewPage(page_id)) != nullptr) {
       return page;
     }
-    allocate_index_ = (allocate_index_ + 1) % num_instances_;
   }
   return nullptr;
 }
 
+uint32_t ParallelBufferPoolManager::PickAllocateInstance() {
+  uint32_t round_robin_index = allocate_index_.fetch_add(1) % num_instances_;
+  if (rebalancing_) {
+    uint32_t best_index = round_robin_index;
+    size_t best_available = bpms_[best_index]->GetNumAvailableFrames();
+    for (uint32_t i = 1; i < num_instances_; ++i) {
+      uint32_t index = (round_robin_index + i) % num_instances_;
+      size_t available = bpms_[index]->GetNumAvailableFrames();
+      if (available > best_available) {
+        best_index = index;
+        best_available = available;
+      }
+    }
+    return best_index;
+  }
+  // Of two choices, take the one with more frames to spare. The home instance keeps a thread's new pages together.
+  auto home_index = static_cast<uint32_t>(std::hash<std::thread::id>{}(std::this_thread::get_id()) % num_instances_);
+  if (home_index != round_robin_index &&
+      bpms_[home_index]->GetNumAvailableFrames() > bpms_[round_robin_index]->GetNumAvailableFrames()) {
+    return home_index;
+  }
+  return round_robin_index;
+}
+
 bool ParallelBufferPoolManager::DeletePgImp(page_id_t page_id) {
   // Delete page_id from responsible BufferPoolManagerInstance
   BufferPoolManager *bpm = GetBufferPoolManager(page_id);
@@ -96,9 +221,14 @@ bool ParallelBufferPoolManager::DeletePgImp(page_id_t page_id) {
 }
 
 void ParallelBufferPoolManager::FlushAllPgsImp() {
-  // flush all pages from all BufferPoolManagerInstances
-  for (uint32_t i = 0; i < num_instances_; ++i) {
-    bpms_[i]->FlushAllPages();
+  // flush all pages from all BufferPoolManagerInstances, in parallel, each on its own thread
+  std::vector<std::thread> flushers;
+  for (uint32_t i = 1; i < num_instances_; ++i) {
+    flushers.emplace_back([this, i] { bpms_[i]->FlushAllPages(); });
+  }
+  bpms_[0]->FlushAllPages();
+  for (auto &flusher : flushers) {
+    flusher.join();
   }
 }
 
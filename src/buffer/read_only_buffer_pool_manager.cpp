@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_only_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/read_only_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/read_only_buffer_pool_manager.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+ReadOnlyBufferPoolManager::PageView::PageView(page_id_t page_id, char *data) : page_(&header_, data) {
+  header_.page_id_ = page_id;
+}
+
+ReadOnlyBufferPoolManager::ReadOnlyBufferPoolManager(DiskManager *disk_manager) : disk_manager_(disk_manager) {
+  mapping_ = disk_manager->MapFile(&num_pages_);
+  views_ = std::make_unique<std::atomic<PageView *>[]>(num_pages_);
+  for (page_id_t i = 0; i < num_pages_; ++i) {
+    views_[i].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+ReadOnlyBufferPoolManager::~ReadOnlyBufferPoolManager() {
+  for (page_id_t i = 0; i < num_pages_; ++i) {
+    delete views_[i].load();
+  }
+}
+
+ReadOnlyBufferPoolManager::PageView *ReadOnlyBufferPoolManager::GetView(page_id_t page_id) {
+  PageView *view = views_[page_id].load(std::memory_order_acquire);
+  if (view != nullptr) {
+    return view;
+  }
+  // Only checked pages get a view, so a page that does not match its checksum is checked again on every fetch.
+  char *data = mapping_ + static_cast<size_t>(page_id) * PAGE_SIZE;
+  if (!disk_manager_->VerifyChecksum(page_id, data)) {
+    return nullptr;
+  }
+  // Racing fetches may both create a view; the one that loses throws its view away.
+  auto *new_view = new PageView(page_id, data);
+  if (views_[page_id].compare_exchange_strong(view, new_view, std::memory_order_acq_rel)) {
+    return new_view;
+  }
+  delete new_view;
+  return view;
+}
+
+Page *ReadOnlyBufferPoolManager::FetchPgImp(page_id_t page_id) {
+  if (page_id < 0 || page_id >= num_pages_) {
+    return nullptr;
+  }
+  PageView *view = GetView(page_id);
+  if (view == nullptr) {
+    return nullptr;
+  }
+  view->header_.pin_count_.fetch_add(1);
+  return &view->page_;
+}
+
+bool ReadOnlyBufferPoolManager::UnpinPgImp(page_id_t page_id, bool is_dirty) {
+  if (is_dirty || page_id < 0 || page_id >= num_pages_) {
+    return false;
+  }
+  PageView *view = views_[page_id].load(std::memory_order_acquire);
+  if (view == nullptr) {
+    return false;
+  }
+  int pin_count = view->header_.pin_count_.load();
+  while (pin_count > 0) {
+    if (view->header_.pin_count_.compare_exchange_weak(pin_count, pin_count - 1)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ReadOnlyBufferPoolManager::FlushPgImp(page_id_t page_id) { return page_id >= 0 && page_id < num_pages_; }
+
+Page *ReadOnlyBufferPoolManager::NewPgImp(page_id_t *page_id) {
+  *page_id = INVALID_PAGE_ID;
+  return nullptr;
+}
+
+bool ReadOnlyBufferPoolManager::DeletePgImp(page_id_t page_id) { return page_id < 0 || page_id >= num_pages_; }
+
+void ReadOnlyBufferPoolManager::Prefetch(page_id_t page_id, size_t num_pages) {
+  if (page_id < 0 || page_id >= num_pages_) {
+    return;
+  }
+  size_t end = std::min(static_cast<size_t>(page_id) + num_pages, static_cast<size_t>(num_pages_));
+  // The mapping starts page aligned and PAGE_SIZE is a multiple of the system page size.
+  madvise(mapping_ + static_cast<size_t>(page_id) * PAGE_SIZE, (end - static_cast<size_t>(page_id)) * PAGE_SIZE,
+          MADV_WILLNEED);
+}
+
+void ReadOnlyBufferPoolManager::AdviseAccessPattern(AccessPattern access_pattern) {
+  if (mapping_ == nullptr) {
+    return;
+  }
+  int advice = MADV_NORMAL;
+  if (access_pattern == AccessPattern::SEQUENTIAL) {
+    advice = MADV_SEQUENTIAL;
+  } else if (access_pattern == AccessPattern::RANDOM) {
+    advice = MADV_RANDOM;
+  }
+  if (madvise(mapping_, static_cast<size_t>(num_pages_) * PAGE_SIZE, advice) != 0) {
+    LOG_DEBUG("madvise on the db file mapping failed");
+  }
+}
+
+}  // namespace bustub
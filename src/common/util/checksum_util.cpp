@@ -0,0 +1,130 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// checksum_util.cpp
+//
+// Identification: src/common/util/checksum_util.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/checksum_util.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+namespace bustub {
+
+#if defined(__SSE4_2__) || defined(__ARM_FEATURE_CRC32)
+
+#if defined(__SSE4_2__)
+static inline uint32_t Crc32cU8(uint32_t crc, uint8_t value) { return _mm_crc32_u8(crc, value); }
+static inline uint32_t Crc32cU64(uint32_t crc, uint64_t value) {
+  return static_cast<uint32_t>(_mm_crc32_u64(crc, value));
+}
+#else
+static inline uint32_t Crc32cU8(uint32_t crc, uint8_t value) { return __crc32cb(crc, value); }
+static inline uint32_t Crc32cU64(uint32_t crc, uint64_t value) { return __crc32cd(crc, value); }
+#endif
+
+static inline uint64_t Load64(const char *data) {
+  uint64_t value;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+/**
+ * The CRC instruction takes a few cycles before its result can be fed back in, but a new one can start every cycle, so
+ * long buffers are checksummed as three interleaved streams of STREAM_LENGTH bytes. A third of a 4 KB page minus a
+ * few bytes, so that a page is a single stripe of three streams.
+ */
+static constexpr size_t STREAM_LENGTH = 1360;
+
+/**
+ * Tables that advance a CRC register over STREAM_LENGTH zero bytes. The register is linear in its starting value, so
+ * the crc of "A then B" is Shift(crc of A) ^ (crc of B started from 0); each table handles one byte of the register.
+ */
+static std::array<std::array<uint32_t, 256>, 4> MakeShiftTables() {
+  std::array<uint32_t, 32> bit_shifts{};
+  for (size_t bit = 0; bit < bit_shifts.size(); ++bit) {
+    uint32_t crc = 1U << bit;
+    for (size_t i = 0; i < STREAM_LENGTH; i += sizeof(uint64_t)) {
+      crc = Crc32cU64(crc, 0);
+    }
+    bit_shifts[bit] = crc;
+  }
+  std::array<std::array<uint32_t, 256>, 4> tables{};
+  for (size_t byte = 0; byte < tables.size(); ++byte) {
+    for (uint32_t value = 0; value < 256; ++value) {
+      for (size_t bit = 0; bit < 8; ++bit) {
+        if ((value & (1U << bit)) != 0) {
+          tables[byte][value] ^= bit_shifts[byte * 8 + bit];
+        }
+      }
+    }
+  }
+  return tables;
+}
+
+static inline uint32_t Shift(const std::array<std::array<uint32_t, 256>, 4> &tables, uint32_t crc) {
+  return tables[0][crc & 0xFF] ^ tables[1][(crc >> 8) & 0xFF] ^ tables[2][(crc >> 16) & 0xFF] ^ tables[3][crc >> 24];
+}
+
+uint32_t ChecksumUtil::Crc32c(const char *data, size_t length) {
+  static_assert(STREAM_LENGTH % sizeof(uint64_t) == 0);
+  static const std::array<std::array<uint32_t, 256>, 4> SHIFT_TABLES = MakeShiftTables();
+  uint32_t crc = ~0U;
+  for (; length >= 3 * STREAM_LENGTH; data += 3 * STREAM_LENGTH, length -= 3 * STREAM_LENGTH) {
+    uint32_t crc1 = 0;
+    uint32_t crc2 = 0;
+    for (size_t i = 0; i < STREAM_LENGTH; i += sizeof(uint64_t)) {
+      crc = Crc32cU64(crc, Load64(data + i));
+      crc1 = Crc32cU64(crc1, Load64(data + STREAM_LENGTH + i));
+      crc2 = Crc32cU64(crc2, Load64(data + 2 * STREAM_LENGTH + i));
+    }
+    crc = Shift(SHIFT_TABLES, Shift(SHIFT_TABLES, crc) ^ crc1) ^ crc2;
+  }
+  for (; length >= sizeof(uint64_t); data += sizeof(uint64_t), length -= sizeof(uint64_t)) {
+    crc = Crc32cU64(crc, Load64(data));
+  }
+  for (; length > 0; ++data, --length) {
+    crc = Crc32cU8(crc, static_cast<uint8_t>(*data));
+  }
+  return ~crc;
+}
+
+#else
+
+/** @return the lookup table of the reflected CRC32C polynomial, one entry per byte value */
+static std::array<uint32_t, 256> MakeCrc32cTable() {
+  std::array<uint32_t, 256> table{};
+  for (uint32_t i = 0; i < table.size(); ++i) {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ ((crc & 1) != 0 ? 0x82F63B78 : 0);
+    }
+    table[i] = crc;
+  }
+  return table;
+}
+
+uint32_t ChecksumUtil::Crc32c(const char *data, size_t length) {
+  static const std::array<uint32_t, 256> TABLE = MakeCrc32cTable();
+  uint32_t crc = ~0U;
+  for (size_t i = 0; i < length; ++i) {
+    crc = (crc >> 8) ^ TABLE[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF];
+  }
+  return ~crc;
+}
+
+#endif
+
+}  // namespace bustub
@@ -0,0 +1,176 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compression_util.cpp
+//
+// Identification: src/common/util/compression_util.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/compression_util.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace bustub {
+
+/** Shortest back-reference; shorter repeats are cheaper as literals. */
+static constexpr size_t MIN_MATCH = 4;
+/** Farthest back-reference, the largest offset that fits into two bytes. */
+static constexpr size_t MAX_OFFSET = 65535;
+/** The match finder remembers the last position of 2^HASH_BITS different four-byte sequences. */
+static constexpr int HASH_BITS = 12;
+/** A run length that does not fit into its four bits of the token continues in extra bytes of up to this much. */
+static constexpr size_t RUN_MASK = 15;
+
+static inline uint32_t Load32(const char *data) {
+  uint32_t value;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+static inline uint32_t Hash(uint32_t sequence) { return (sequence * 2654435761U) >> (32 - HASH_BITS); }
+
+/** Append the extra bytes of a run length of at least RUN_MASK. @return false if they do not fit */
+static inline bool PutLength(size_t length, char *dst, size_t dst_capacity, size_t *op) {
+  for (length -= RUN_MASK; length >= 255; length -= 255) {
+    if (*op >= dst_capacity) {
+      return false;
+    }
+    dst[(*op)++] = static_cast<char>(255);
+  }
+  if (*op >= dst_capacity) {
+    return false;
+  }
+  dst[(*op)++] = static_cast<char>(length);
+  return true;
+}
+
+/** Read the extra bytes of a run length. @return false if the input ends first */
+static inline bool GetLength(const char *src, size_t src_length, size_t *ip, size_t *length) {
+  uint8_t byte;
+  do {
+    if (*ip >= src_length) {
+      return false;
+    }
+    byte = static_cast<uint8_t>(src[(*ip)++]);
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+/**
+ * Append a sequence: a literal run, then a back-reference unless match_length is 0, which ends the output.
+ * @return false if it does not fit
+ */
+static bool PutSequence(const char *literals, size_t num_literals, size_t offset, size_t match_length, char *dst,
+                        size_t dst_capacity, size_t *op) {
+  if (*op >= dst_capacity) {
+    return false;
+  }
+  size_t token = *op;
+  ++*op;
+  dst[token] = static_cast<char>(std::min(num_literals, RUN_MASK) << 4);
+  if (num_literals >= RUN_MASK && !PutLength(num_literals, dst, dst_capacity, op)) {
+    return false;
+  }
+  if (*op + num_literals > dst_capacity) {
+    return false;
+  }
+  memcpy(dst + *op, literals, num_literals);
+  *op += num_literals;
+  if (match_length == 0) {
+    return true;
+  }
+  if (*op + 2 > dst_capacity) {
+    return false;
+  }
+  dst[(*op)++] = static_cast<char>(offset & 0xFF);
+  dst[(*op)++] = static_cast<char>(offset >> 8);
+  dst[token] = static_cast<char>(dst[token] | std::min(match_length - MIN_MATCH, RUN_MASK));
+  return match_length - MIN_MATCH < RUN_MASK || PutLength(match_length - MIN_MATCH, dst, dst_capacity, op);
+}
+
+size_t CompressionUtil::Compress(const char *src, size_t src_length, char *dst, size_t dst_capacity) {
+  // positions of earlier four-byte sequences by hash; a stale or colliding entry is caught by comparing the bytes
+  uint32_t last_seen[1 << HASH_BITS] = {0};
+  size_t ip = 0;
+  size_t anchor = 0;
+  size_t op = 0;
+  while (ip + MIN_MATCH <= src_length) {
+    uint32_t sequence = Load32(src + ip);
+    uint32_t hash = Hash(sequence);
+    size_t candidate = last_seen[hash];
+    last_seen[hash] = static_cast<uint32_t>(ip);
+    if (candidate >= ip || ip - candidate > MAX_OFFSET || Load32(src + candidate) != sequence) {
+      // skip ahead faster the longer nothing matches, as the data is probably incompressible
+      ip += 1 + ((ip - anchor) >> 6);
+      continue;
+    }
+    size_t match_length = MIN_MATCH;
+    while (ip + match_length < src_length && src[candidate + match_length] == src[ip + match_length]) {
+      ++match_length;
+    }
+    if (!PutSequence(src + anchor, ip - anchor, ip - candidate, match_length, dst, dst_capacity, &op)) {
+      return 0;
+    }
+    ip += match_length;
+    anchor = ip;
+  }
+  if (!PutSequence(src + anchor, src_length - anchor, 0, 0, dst, dst_capacity, &op)) {
+    return 0;
+  }
+  return op;
+}
+
+bool CompressionUtil::Decompress(const char *src, size_t src_length, char *dst, size_t dst_length) {
+  size_t ip = 0;
+  size_t op = 0;
+  while (ip < src_length) {
+    auto token = static_cast<uint8_t>(src[ip++]);
+    size_t num_literals = token >> 4;
+    if (num_literals == RUN_MASK && !GetLength(src, src_length, &ip, &num_literals)) {
+      return false;
+    }
+    if (ip + num_literals > src_length || op + num_literals > dst_length) {
+      return false;
+    }
+    memcpy(dst + op, src + ip, num_literals);
+    ip += num_literals;
+    op += num_literals;
+    // the last sequence has no back-reference
+    if (ip == src_length) {
+      break;
+    }
+    if (ip + 2 > src_length) {
+      return false;
+    }
+    size_t offset = static_cast<uint8_t>(src[ip]) | (static_cast<size_t>(static_cast<uint8_t>(src[ip + 1])) << 8);
+    ip += 2;
+    size_t match_length = token & RUN_MASK;
+    if (match_length == RUN_MASK && !GetLength(src, src_length, &ip, &match_length)) {
+      return false;
+    }
+    match_length += MIN_MATCH;
+    if (offset == 0 || offset > op || op + match_length > dst_length) {
+      return false;
+    }
+    const char *match = dst + op - offset;
+    if (offset >= match_length) {
+      memcpy(dst + op, match, match_length);
+    } else {
+      // the reference overlaps the bytes it produces, e.g. a run of one repeated byte
+      for (size_t i = 0; i < match_length; ++i) {
+        dst[op + i] = match[i];
+      }
+    }
+    op += match_length;
+  }
+  return op == dst_length;
+}
+
+}  // namespace bustub
@@ -10,9 +10,14 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <chrono>  // NOLINT
 #include <fstream>
 #include <iostream>
+#include <numeric>
 #include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -41,13 +46,14 @@ HASH_TABLE_TYPE::ExtendibleHashTable(const std::string &name, BufferPoolManager
   auto page = buffer_pool_manager_->NewPage(&directory_page_id_);
   auto dir_page = reinterpret_cast<HashTableDirectoryPage *>(page->GetData());
   page_id_t first_bucket_page_id;
-  assert(buffer_pool_manager_->NewPage(&first_bucket_page_id) != nullptr);
+  [[maybe_unused]] Page *first_bucket_page = buffer_pool_manager_->NewPage(&first_bucket_page_id);
+  assert(first_bucket_page != nullptr);
   dir_page->Init();
   dir_page->SetPageId(directory_page_id_);
   dir_page->SetLocalDepth(0, 0);
   dir_page->SetBucketPageId(0, first_bucket_page_id);
-  assert(buffer_pool_manager_->UnpinPage(first_bucket_page_id, true));
-  assert(buffer_pool_manager_->UnpinPage(directory_page_id_, true));
+  UnpinPage(first_bucket_page_id, true);
+  UnpinPage(directory_page_id_, true);
 }
 
 /*****************************************************************************
@@ -65,6 +71,11 @@ uint32_t HASH_TABLE_TYPE::Hash(KeyType key) {
   return static_cast<uint32_t>(hash_fn_.GetHash(key));
 }
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+inline uint8_t HASH_TABLE_TYPE::KeyToFingerprint(KeyType key) {
+  return HASH_TABLE_BUCKET_TYPE::HashToFingerprint(hash_fn_.GetHash(key));
+}
+
 template <typename KeyType, typename ValueType, typename KeyComparator>
 inline uint32_t HASH_TABLE_TYPE::KeyToDirectoryIndex(KeyType key, HashTableDirectoryPage *dir_page) {
   return hash_fn_.GetHash(key) & dir_page->GetGlobalDepthMask();
@@ -72,7 +83,7 @@ inline uint32_t HASH_TABLE_TYPE::KeyToDirectoryIndex(KeyType key, HashTableDirec
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 inline page_id_t HASH_TABLE_TYPE::KeyToPageId(KeyType key, HashTableDirectoryPage *dir_page) {
-  return dir_page->GetBucketPageId(KeyToDirectoryIndex(key, dir_page));
+  return GetSlotBucketPageId(dir_page, KeyToDirectoryIndex(key, dir_page));
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
@@ -87,70 +98,362 @@ HASH_TABLE_BUCKET_TYPE *HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_i
   return reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(bucket_page->GetData());
 }
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::UnpinPage(page_id_t page_id, bool is_dirty) {
+  [[maybe_unused]] bool unpinned = buffer_pool_manager_->UnpinPage(page_id, is_dirty);
+  assert(unpinned);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HashTableDirectoryPage *HASH_TABLE_TYPE::FetchDirectorySegment(HashTableDirectoryPage *dir_page, uint32_t *bucket_idx) {
+  uint32_t segment_idx = *bucket_idx / DIRECTORY_ARRAY_SIZE;
+  *bucket_idx %= DIRECTORY_ARRAY_SIZE;
+  if (segment_idx == 0) {
+    return dir_page;
+  }
+  Page *segment = buffer_pool_manager_->FetchPage(dir_page->GetSegmentPageId(segment_idx));
+  return segment == nullptr ? nullptr : reinterpret_cast<HashTableDirectoryPage *>(segment->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::UnpinDirectorySegment(HashTableDirectoryPage *dir_page, HashTableDirectoryPage *segment,
+                                            bool is_dirty) {
+  if (segment != dir_page) {
+    buffer_pool_manager_->UnpinPage(segment->GetPageId(), is_dirty);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::PinDirectorySegments(HashTableDirectoryPage *dir_page) {
+  uint32_t num_segments = dir_page->Size() / DIRECTORY_ARRAY_SIZE;
+  for (uint32_t segment_idx = 1; segment_idx < num_segments; ++segment_idx) {
+    if (buffer_pool_manager_->FetchPage(dir_page->GetSegmentPageId(segment_idx)) == nullptr) {
+      for (uint32_t i = 1; i < segment_idx; ++i) {
+        UnpinPage(dir_page->GetSegmentPageId(i), false);
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::UnpinDirectorySegments(HashTableDirectoryPage *dir_page) {
+  uint32_t num_segments = dir_page->Size() / DIRECTORY_ARRAY_SIZE;
+  for (uint32_t segment_idx = 1; segment_idx < num_segments; ++segment_idx) {
+    UnpinPage(dir_page->GetSegmentPageId(segment_idx), false);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::GetSlotLocalDepth(HashTableDirectoryPage *dir_page, uint32_t bucket_idx,
+                                        uint32_t *local_depth) {
+  auto *segment = FetchDirectorySegment(dir_page, &bucket_idx);
+  if (segment == nullptr) {
+    return false;
+  }
+  *local_depth = segment->GetLocalDepth(bucket_idx);
+  UnpinDirectorySegment(dir_page, segment, false);
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+page_id_t HASH_TABLE_TYPE::GetSlotBucketPageId(HashTableDirectoryPage *dir_page, uint32_t bucket_idx) {
+  auto *segment = FetchDirectorySegment(dir_page, &bucket_idx);
+  if (segment == nullptr) {
+    return INVALID_PAGE_ID;
+  }
+  page_id_t bucket_page_id = segment->GetBucketPageId(bucket_idx);
+  UnpinDirectorySegment(dir_page, segment, false);
+  return bucket_page_id;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::SetSlot(HashTableDirectoryPage *dir_page, uint32_t bucket_idx, uint32_t local_depth,
+                              page_id_t bucket_page_id) {
+  auto *segment = FetchDirectorySegment(dir_page, &bucket_idx);
+  if (segment == nullptr) {
+    return false;
+  }
+  segment->SetLocalDepth(bucket_idx, local_depth);
+  segment->SetBucketPageId(bucket_idx, bucket_page_id);
+  UnpinDirectorySegment(dir_page, segment, true);
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::GrowDirectory(HashTableDirectoryPage *dir_page) {
+  uint32_t size = dir_page->Size();
+  if (size == DIRECTORY_MAX_SIZE) {
+    return false;
+  }
+  // Fill in the new half before it becomes part of the directory, so that lookups never meet an unset slot.
+  if (size < DIRECTORY_ARRAY_SIZE) {
+    for (uint32_t i = 0; i < size; ++i) {
+      dir_page->SetLocalDepth(size + i, dir_page->GetLocalDepth(i));
+      dir_page->SetBucketPageId(size + i, dir_page->GetBucketPageId(i));
+    }
+    dir_page->IncrGlobalDepth();
+    return true;
+  }
+  uint32_t num_segments = size / DIRECTORY_ARRAY_SIZE;
+  for (uint32_t segment_idx = 0; segment_idx < num_segments; ++segment_idx) {
+    uint32_t image_idx = num_segments + segment_idx;
+    if (dir_page->GetSegmentPageId(image_idx) == INVALID_PAGE_ID) {
+      page_id_t segment_page_id;
+      Page *segment = buffer_pool_manager_->NewPage(&segment_page_id);
+      if (segment == nullptr) {
+        return false;
+      }
+      auto *segment_page = reinterpret_cast<HashTableDirectoryPage *>(segment->GetData());
+      segment_page->Init();
+      segment_page->SetPageId(segment_page_id);
+      buffer_pool_manager_->UnpinPage(segment_page_id, true);
+      dir_page->SetSegmentPageId(image_idx, segment_page_id);
+    }
+    uint32_t bucket_idx = segment_idx * DIRECTORY_ARRAY_SIZE;
+    uint32_t image_bucket_idx = image_idx * DIRECTORY_ARRAY_SIZE;
+    auto *segment = FetchDirectorySegment(dir_page, &bucket_idx);
+    auto *image = FetchDirectorySegment(dir_page, &image_bucket_idx);
+    if (segment == nullptr || image == nullptr) {
+      if (segment != nullptr) {
+        UnpinDirectorySegment(dir_page, segment, false);
+      }
+      if (image != nullptr) {
+        UnpinDirectorySegment(dir_page, image, false);
+      }
+      return false;
+    }
+    for (uint32_t i = 0; i < DIRECTORY_ARRAY_SIZE; ++i) {
+      image->SetLocalDepth(i, segment->GetLocalDepth(i));
+      image->SetBucketPageId(i, segment->GetBucketPageId(i));
+    }
+    UnpinDirectorySegment(dir_page, segment, false);
+    UnpinDirectorySegment(dir_page, image, true);
+  }
+  dir_page->IncrGlobalDepth();
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::CanShrinkDirectory(HashTableDirectoryPage *dir_page) {
+  uint32_t size = dir_page->Size();
+  if (size <= DIRECTORY_ARRAY_SIZE) {
+    return dir_page->CanShrink();
+  }
+  uint32_t global_depth = dir_page->GetGlobalDepth();
+  for (uint32_t first_idx = 0; first_idx < size; first_idx += DIRECTORY_ARRAY_SIZE) {
+    uint32_t bucket_idx = first_idx;
+    auto *segment = FetchDirectorySegment(dir_page, &bucket_idx);
+    if (segment == nullptr) {
+      return false;
+    }
+    bool can_shrink = true;
+    for (uint32_t i = 0; i < DIRECTORY_ARRAY_SIZE && can_shrink; ++i) {
+      can_shrink = segment->GetLocalDepth(i) < global_depth;
+    }
+    UnpinDirectorySegment(dir_page, segment, false);
+    if (!can_shrink) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+Page *HASH_TABLE_TYPE::FetchLatchedBucketPage(const KeyType &key, HashTableDirectoryPage *dir_page, bool exclusive,
+                                              page_id_t *bucket_page_id) {
+  while (true) {
+    uint64_t version = directory_version_.load(std::memory_order_acquire);
+    if ((version & 1) != 0) {
+      std::this_thread::yield();
+      continue;
+    }
+    *bucket_page_id = KeyToPageId(key, dir_page);
+    Page *raw_bucket_page =
+        *bucket_page_id == INVALID_PAGE_ID ? nullptr : buffer_pool_manager_->FetchPage(*bucket_page_id);
+    if (raw_bucket_page == nullptr) {
+      if (directory_version_.load(std::memory_order_acquire) == version) {
+        return nullptr;
+      }
+      continue;
+    }
+    if (exclusive) {
+      raw_bucket_page->WLatch();
+    } else {
+      raw_bucket_page->RLatch();
+    }
+    // The directory reads above must not move past the version check.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (directory_version_.load(std::memory_order_relaxed) == version) {
+      return raw_bucket_page;
+    }
+    if (exclusive) {
+      raw_bucket_page->WUnlatch();
+    } else {
+      raw_bucket_page->RUnlatch();
+    }
+    buffer_pool_manager_->UnpinPage(*bucket_page_id, false);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::BeginDirectoryUpdate() {
+  directory_version_.store(directory_version_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::EndDirectoryUpdate() {
+  directory_version_.store(directory_version_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) {
-  table_latch_.RLock();
   auto *dir_page = FetchDirectoryPage();
-  page_id_t bucket_page_id = KeyToPageId(key, dir_page);
-  auto *raw_bucket_page = buffer_pool_manager_->FetchPage(bucket_page_id);
-  raw_bucket_page->RLatch();
+  page_id_t bucket_page_id;
+  auto *raw_bucket_page = FetchLatchedBucketPage(key, dir_page, false, &bucket_page_id);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  if (raw_bucket_page == nullptr) {
+    return false;
+  }
   auto *bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(raw_bucket_page->GetData());
-  bool matched = bucket_page->GetValue(key, comparator_, result);
+  bool matched = bucket_page->GetValue(key, comparator_, result, KeyToFingerprint(key));
   raw_bucket_page->RUnlatch();
   buffer_pool_manager_->UnpinPage(bucket_page_id, false);
-  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
-  table_latch_.RUnlock();
   return matched;
 }
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+size_t HASH_TABLE_TYPE::GetValues(Transaction *transaction, const std::vector<KeyType> &keys,
+                                  std::vector<std::vector<ValueType>> *results) {
+  results->resize(keys.size());
+  size_t num_matched = 0;
+  std::vector<size_t> pending(keys.size());
+  std::iota(pending.begin(), pending.end(), 0);
+  // Keys whose bucket could not be fetched, looked up one by one once the batch's pages are unpinned.
+  std::vector<size_t> unfetched;
+  auto *dir_page = FetchDirectoryPage();
+  while (!pending.empty()) {
+    uint64_t version = directory_version_.load(std::memory_order_acquire);
+    if ((version & 1) != 0) {
+      std::this_thread::yield();
+      continue;
+    }
+    std::vector<std::pair<page_id_t, size_t>> key_buckets;
+    key_buckets.reserve(pending.size());
+    for (size_t key_idx : pending) {
+      key_buckets.emplace_back(KeyToPageId(keys[key_idx], dir_page), key_idx);
+    }
+    pending.clear();
+    std::sort(key_buckets.begin(), key_buckets.end());
+
+    // Keys whose directory segment could not be fetched map to INVALID_PAGE_ID, which sorts first.
+    auto group_begin = key_buckets.begin();
+    for (; group_begin != key_buckets.end() && group_begin->first == INVALID_PAGE_ID; ++group_begin) {
+      unfetched.push_back(group_begin->second);
+    }
+    while (group_begin != key_buckets.end()) {
+      // Take the keys of the next GET_VALUES_BATCH_SIZE buckets.
+      std::vector<page_id_t> bucket_page_ids;
+      std::vector<decltype(group_begin)> group_ends;
+      auto group_end = group_begin;
+      while (group_end != key_buckets.end() && bucket_page_ids.size() < GET_VALUES_BATCH_SIZE) {
+        page_id_t bucket_page_id = group_end->first;
+        while (group_end != key_buckets.end() && group_end->first == bucket_page_id) {
+          ++group_end;
+        }
+        bucket_page_ids.push_back(bucket_page_id);
+        group_ends.push_back(group_end);
+      }
+      std::vector<Page *> raw_bucket_pages(bucket_page_ids.size());
+      buffer_pool_manager_->FetchPages(bucket_page_ids, raw_bucket_pages.data());
+
+      // Each bucket is latched on its own and validated like in FetchLatchedBucketPage. Its keys are looked up again
+      // if the directory changed since they were mapped.
+      std::vector<page_id_t> fetched_page_ids;
+      for (size_t i = 0; i < bucket_page_ids.size(); ++i) {
+        Page *raw_bucket_page = raw_bucket_pages[i];
+        if (raw_bucket_page == nullptr) {
+          for (; group_begin != group_ends[i]; ++group_begin) {
+            unfetched.push_back(group_begin->second);
+          }
+          continue;
+        }
+        fetched_page_ids.push_back(bucket_page_ids[i]);
+        raw_bucket_page->RLatch();
+        std::atomic_thread_fence(std::memory_order_acquire);
+        bool is_valid = directory_version_.load(std::memory_order_relaxed) == version;
+        auto *bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(raw_bucket_page->GetData());
+        for (; group_begin != group_ends[i]; ++group_begin) {
+          size_t key_idx = group_begin->second;
+          if (!is_valid) {
+            pending.push_back(key_idx);
+          } else if (bucket_page->GetValue(keys[key_idx], comparator_, &(*results)[key_idx],
+                                           KeyToFingerprint(keys[key_idx]))) {
+            ++num_matched;
+          }
+        }
+        raw_bucket_page->RUnlatch();
+      }
+      buffer_pool_manager_->UnpinPages(fetched_page_ids, false);
+    }
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  for (size_t key_idx : unfetched) {
+    if (GetValue(transaction, keys[key_idx], &(*results)[key_idx])) {
+      ++num_matched;
+    }
+  }
+  return num_matched;
+}
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  table_latch_.RLock();
   auto *dir_page = FetchDirectoryPage();
-  page_id_t bucket_page_id = KeyToPageId(key, dir_page);
-  auto *raw_bucket_page = buffer_pool_manager_->FetchPage(bucket_page_id);
-  raw_bucket_page->WLatch();
+  page_id_t bucket_page_id;
+  auto *raw_bucket_page = FetchLatchedBucketPage(key, dir_page, true, &bucket_page_id);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  if (raw_bucket_page == nullptr) {
+    return false;
+  }
   auto *bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(raw_bucket_page->GetData());
   bool is_succeed = false;
   if (!bucket_page->IsFull()) {
-    is_succeed = bucket_page->Insert(key, value, comparator_);
+    is_succeed = bucket_page->Insert(key, value, comparator_, KeyToFingerprint(key));
     raw_bucket_page->WUnlatch();
-    table_latch_.RUnlock();
-    buffer_pool_manager_->UnpinPage(directory_page_id_, false);
     buffer_pool_manager_->UnpinPage(bucket_page_id, true);
     return is_succeed;
   }
   std::vector<ValueType> res;
-  bucket_page->GetValue(key, comparator_, &res);
+  bucket_page->GetValue(key, comparator_, &res, KeyToFingerprint(key));
   if (!res.empty()) {
     for (const auto &val : res) {
       if (val == value) {
         raw_bucket_page->WUnlatch();
-        table_latch_.RUnlock();
-        buffer_pool_manager_->UnpinPage(directory_page_id_, false);
         buffer_pool_manager_->UnpinPage(bucket_page_id, false);
         return false;
       }
     }
   }
   raw_bucket_page->WUnlatch();
-  table_latch_.RUnlock();
-  assert(buffer_pool_manager_->UnpinPage(directory_page_id_, false));
-  assert(buffer_pool_manager_->UnpinPage(bucket_page_id, false));
+  UnpinPage(bucket_page_id, false);
   is_succeed = SplitInsert(transaction, key, value);
   return is_succeed;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  table_latch_.WLock();
-  auto dir_page = FetchDirectoryPage();
+  // Lookups, inserts and removes in other buckets go on while the directory page is latched here.
+  Page *raw_dir_page = buffer_pool_manager_->FetchPage(directory_page_id_);
+  raw_dir_page->WLatch();
+  auto *dir_page = reinterpret_cast<HashTableDirectoryPage *>(raw_dir_page->GetData());
   page_id_t old_bucket_page_id = KeyToPageId(key, dir_page);
   auto *raw_old_bucket_page = buffer_pool_manager_->FetchPage(old_bucket_page_id);
   raw_old_bucket_page->WLatch();
@@ -159,20 +462,20 @@ bool HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
   bool insert_succeed = false;
   bool insert_finished = false;
   if (!old_bucket_page->IsFull()) {
-    insert_succeed = old_bucket_page->Insert(key, value, comparator_);
+    insert_succeed = old_bucket_page->Insert(key, value, comparator_, KeyToFingerprint(key));
     raw_old_bucket_page->WUnlatch();
-    table_latch_.WUnlock();
+    raw_dir_page->WUnlatch();
     buffer_pool_manager_->UnpinPage(old_bucket_page_id, true);
     buffer_pool_manager_->UnpinPage(directory_page_id_, false);
     return insert_succeed;
   }
   std::vector<ValueType> res;
-  old_bucket_page->GetValue(key, comparator_, &res);
+  old_bucket_page->GetValue(key, comparator_, &res, KeyToFingerprint(key));
   if (!res.empty()) {
     for (const auto &val : res) {
       if (val == value) {
         raw_old_bucket_page->WUnlatch();
-        table_latch_.RUnlock();
+        raw_dir_page->WUnlatch();
         buffer_pool_manager_->UnpinPage(directory_page_id_, false);
         buffer_pool_manager_->UnpinPage(old_bucket_page_id, false);
         return false;
@@ -183,34 +486,50 @@ bool HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
   page_id_t insert_page_id;
   Page *raw_insert_page;
   while (!insert_finished) {
-    if (dir_page->GetLocalDepth(old_index) >= dir_page->GetGlobalDepth()) {
-      uint32_t prev_size = dir_page->Size();
-      dir_page->IncrGlobalDepth();
-      uint32_t cur_size = dir_page->Size();
-      for (uint32_t i = prev_size; i < cur_size; ++i) {
-        uint32_t image_index = i - prev_size;
-        dir_page->SetLocalDepth(i, dir_page->GetLocalDepth(image_index));
-        dir_page->SetBucketPageId(i, dir_page->GetBucketPageId(image_index));
-      }
+    uint32_t local_depth;
+    if (!GetSlotLocalDepth(dir_page, old_index, &local_depth)) {
+      raw_old_bucket_page->WUnlatch();
+      UnpinPage(old_bucket_page_id, true);
+      break;
+    }
+    if (local_depth >= dir_page->GetGlobalDepth() && dir_page->Size() == DIRECTORY_MAX_SIZE) {
+      LOG_DEBUG("the hash table directory is full");
+      raw_old_bucket_page->WUnlatch();
+      UnpinPage(old_bucket_page_id, true);
+      break;
     }
     page_id_t new_bucket_page_id;
     Page *raw_new_bucket_page = buffer_pool_manager_->NewPage(&new_bucket_page_id);
+    if (raw_new_bucket_page == nullptr) {
+      raw_old_bucket_page->WUnlatch();
+      UnpinPage(old_bucket_page_id, true);
+      break;
+    }
     raw_new_bucket_page->WLatch();
     auto new_bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(raw_new_bucket_page->GetData());
-    uint32_t split_index = dir_page->GetSplitImageIndex(old_index);
-    dir_page->IncrLocalDepth(old_index);
-    uint32_t local_depth_mask = dir_page->GetLocalDepthMask(old_index);
-    for (uint32_t i = 0; i < dir_page->Size(); ++i) {
-      if ((i & local_depth_mask) == (old_index & local_depth_mask)) {
-        if (i != old_index) {
-          dir_page->IncrLocalDepth(i);
-        }
-      }
-      if ((i & local_depth_mask) == (split_index & local_depth_mask)) {
-        dir_page->IncrLocalDepth(i);
-        dir_page->SetBucketPageId(i, new_bucket_page_id);
-      }
+    // A grown directory is valid on its own, so giving up on the split after growing it leaves nothing to undo.
+    BeginDirectoryUpdate();
+    if ((local_depth >= dir_page->GetGlobalDepth() && !GrowDirectory(dir_page)) || !PinDirectorySegments(dir_page)) {
+      EndDirectoryUpdate();
+      raw_new_bucket_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(new_bucket_page_id, false);
+      buffer_pool_manager_->DeletePage(new_bucket_page_id);
+      raw_old_bucket_page->WUnlatch();
+      UnpinPage(old_bucket_page_id, true);
+      break;
+    }
+    // The old bucket has every 2^local_depth-th slot from the lowest one. Those with that bit set go to the new bucket.
+    uint32_t high_bit = 1U << local_depth;
+    uint32_t split_index = (old_index & (high_bit - 1)) | high_bit;
+    uint32_t local_depth_mask = (high_bit << 1) - 1;
+    for (uint32_t i = old_index & (high_bit - 1); i < dir_page->Size(); i += high_bit) {
+      [[maybe_unused]] bool is_set =
+          SetSlot(dir_page, i, local_depth + 1, (i & high_bit) != 0 ? new_bucket_page_id : old_bucket_page_id);
+      assert(is_set);
     }
+    UnpinDirectorySegments(dir_page);
+    EndDirectoryUpdate();
+    // Both buckets stay latched until their entries are in place.
     for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE; ++i) {
       if (old_bucket_page->IsReadable(i)) {
         KeyType tmp_key = old_bucket_page->KeyAt(i);
@@ -218,29 +537,29 @@ bool HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
         if ((local_depth_mask & tmp_index) == split_index) {
           ValueType tmp_value = old_bucket_page->ValueAt(i);
           old_bucket_page->RemoveAt(i);
-          new_bucket_page->Insert(tmp_key, tmp_value, comparator_);
+          new_bucket_page->Insert(tmp_key, tmp_value, comparator_, old_bucket_page->FingerprintAt(i));
         }
       }
     }
     uint32_t new_index = KeyToDirectoryIndex(key, dir_page);
-    if (dir_page->GetBucketPageId(new_index) == old_bucket_page_id) {
+    if ((new_index & high_bit) == 0) {
       insert_page = old_bucket_page;
       insert_page_id = old_bucket_page_id;
       raw_insert_page = raw_old_bucket_page;
       raw_new_bucket_page->WUnlatch();
-      assert(buffer_pool_manager_->UnpinPage(new_bucket_page_id, true));
+      UnpinPage(new_bucket_page_id, true);
     } else {
       insert_page = new_bucket_page;
       insert_page_id = new_bucket_page_id;
       raw_insert_page = raw_new_bucket_page;
       raw_old_bucket_page->WUnlatch();
-      assert(buffer_pool_manager_->UnpinPage(old_bucket_page_id, true));
+      UnpinPage(old_bucket_page_id, true);
     }
     if (!insert_page->IsFull()) {
-      insert_succeed = insert_page->Insert(key, value, comparator_);
+      insert_succeed = insert_page->Insert(key, value, comparator_, KeyToFingerprint(key));
       insert_finished = true;
       raw_insert_page->WUnlatch();
-      assert(buffer_pool_manager_->UnpinPage(insert_page_id, true));
+      UnpinPage(insert_page_id, true);
     } else {  // after split page, because of the imbalance, we need split the page again.
       old_bucket_page = insert_page;
       raw_old_bucket_page = raw_insert_page;
@@ -248,41 +567,190 @@ bool HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
       old_index = new_index;
     }
   }
-  table_latch_.WUnlock();
-  assert(buffer_pool_manager_->UnpinPage(directory_page_id_, true));
+  raw_dir_page->WUnlatch();
+  UnpinPage(directory_page_id_, true);
   return insert_succeed;
 }
 
 /*****************************************************************************
- * REMOVE
+ * BULK LOAD
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  bool is_merge = false;
-  table_latch_.RLock();
-  auto dir_page = FetchDirectoryPage();
-  page_id_t bucket_page_id = KeyToPageId(key, dir_page);
-  uint32_t bucket_index = KeyToDirectoryIndex(key, dir_page);
-  auto *raw_bucket_page = buffer_pool_manager_->FetchPage(bucket_page_id);
-  raw_bucket_page->WLatch();
-  auto *bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(raw_bucket_page->GetData());
-  bool remove_succeed = bucket_page->Remove(key, value, comparator_);
-  if (bucket_page->IsEmpty() && dir_page->GetGlobalDepth() && dir_page->GetLocalDepth(bucket_index)) {
-    uint32_t merge_index = dir_page->GetMergeImageIndex(bucket_index);
-    if (dir_page->GetLocalDepth(merge_index) == dir_page->GetLocalDepth(bucket_index)) {
-      is_merge = true;
-      table_latch_.RUnlock();
+bool HASH_TABLE_TYPE::BulkLoad(Transaction *transaction, const std::vector<std::pair<KeyType, ValueType>> &entries,
+                               size_t expected_num_entries) {
+  Page *raw_dir_page = buffer_pool_manager_->FetchPage(directory_page_id_);
+  raw_dir_page->WLatch();
+  auto *dir_page = reinterpret_cast<HashTableDirectoryPage *>(raw_dir_page->GetData());
+  // In an empty table, every slot points at the first bucket until the load is done, so latching it keeps other
+  // operations out.
+  page_id_t first_bucket_page_id = dir_page->GetBucketPageId(0);
+  Page *raw_first_bucket_page = buffer_pool_manager_->FetchPage(first_bucket_page_id);
+  raw_first_bucket_page->WLatch();
+  auto *first_bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(raw_first_bucket_page->GetData());
+  std::vector<size_t> overflow;
+  bool all_inserted = true;
+  if (!LoadBuckets(dir_page, first_bucket_page, entries, std::max(expected_num_entries, entries.size()), &overflow,
+                   &all_inserted)) {
+    overflow.resize(entries.size());
+    std::iota(overflow.begin(), overflow.end(), 0);
+  }
+  raw_first_bucket_page->WUnlatch();
+  UnpinPage(first_bucket_page_id, true);
+  raw_dir_page->WUnlatch();
+  UnpinPage(directory_page_id_, true);
+  for (size_t entry_idx : overflow) {
+    all_inserted = Insert(transaction, entries[entry_idx].first, entries[entry_idx].second) && all_inserted;
+  }
+  return all_inserted;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::LoadBuckets(HashTableDirectoryPage *dir_page, HASH_TABLE_BUCKET_TYPE *first_bucket_page,
+                                  const std::vector<std::pair<KeyType, ValueType>> &entries,
+                                  size_t expected_num_entries, std::vector<size_t> *overflow, bool *all_inserted) {
+  std::vector<uint64_t> hashes;
+  hashes.reserve(entries.size());
+  for (const auto &entry : entries) {
+    hashes.push_back(hash_fn_.GetHash(entry.first));
+  }
+  // Leave a quarter of each bucket free on average, so that few buckets overflow where the hashes cluster. A table
+  // that is not empty keeps its directory.
+  bool is_empty = dir_page->GetGlobalDepth() == 0 && first_bucket_page->IsEmpty();
+  uint32_t global_depth = dir_page->GetGlobalDepth();
+  while (is_empty && (expected_num_entries >> global_depth) > BUCKET_ARRAY_SIZE * 3 / 4 &&
+         (1U << global_depth) < DIRECTORY_MAX_SIZE) {
+    ++global_depth;
+  }
+  uint32_t num_buckets = 1U << global_depth;
+  uint32_t global_depth_mask = num_buckets - 1;
+
+  // Order the pairs by the slot they map to, so that each bucket's pairs are next to each other.
+  std::vector<size_t> bucket_begin(num_buckets + 1, 0);
+  for (uint64_t hash : hashes) {
+    ++bucket_begin[(hash & global_depth_mask) + 1];
+  }
+  for (uint32_t bucket_idx = 0; bucket_idx < num_buckets; ++bucket_idx) {
+    bucket_begin[bucket_idx + 1] += bucket_begin[bucket_idx];
+  }
+  std::vector<size_t> order(entries.size());
+  std::vector<size_t> next(bucket_begin.begin(), bucket_begin.end() - 1);
+  for (size_t entry_idx = 0; entry_idx < entries.size(); ++entry_idx) {
+    order[next[hashes[entry_idx] & global_depth_mask]++] = entry_idx;
+  }
+  next.clear();
+  next.shrink_to_fit();
+  auto fill_bucket = [&](HASH_TABLE_BUCKET_TYPE *bucket_page, uint32_t bucket_idx) {
+    for (size_t i = bucket_begin[bucket_idx]; i < bucket_begin[bucket_idx + 1]; ++i) {
+      size_t entry_idx = order[i];
+      if (bucket_page->IsFull()) {
+        overflow->push_back(entry_idx);
+        continue;
+      }
+      *all_inserted = bucket_page->Insert(entries[entry_idx].first, entries[entry_idx].second, comparator_,
+                                          HASH_TABLE_BUCKET_TYPE::HashToFingerprint(hashes[entry_idx])) &&
+                      *all_inserted;
+    }
+  };
+
+  // The directory does not change, so each slot's bucket is latched while its pairs are appended. Slots that share a
+  // bucket latch it in turn.
+  if (!is_empty) {
+    page_id_t first_bucket_page_id = dir_page->GetBucketPageId(0);
+    for (uint32_t bucket_idx = 0; bucket_idx < num_buckets; ++bucket_idx) {
+      if (bucket_begin[bucket_idx] == bucket_begin[bucket_idx + 1]) {
+        continue;
+      }
+      page_id_t bucket_page_id = GetSlotBucketPageId(dir_page, bucket_idx);
+      if (bucket_page_id == first_bucket_page_id) {
+        fill_bucket(first_bucket_page, bucket_idx);
+        continue;
+      }
+      Page *raw_bucket_page = buffer_pool_manager_->FetchPage(bucket_page_id);
+      if (raw_bucket_page == nullptr) {
+        overflow->insert(overflow->end(), order.begin() + bucket_begin[bucket_idx],
+                         order.begin() + bucket_begin[bucket_idx + 1]);
+        continue;
+      }
+      raw_bucket_page->WLatch();
+      fill_bucket(reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(raw_bucket_page->GetData()), bucket_idx);
       raw_bucket_page->WUnlatch();
       buffer_pool_manager_->UnpinPage(bucket_page_id, true);
-      buffer_pool_manager_->UnpinPage(directory_page_id_, false);
-      Merge(transaction, key, value);
     }
+    return true;
   }
-  if (!is_merge) {
-    table_latch_.RUnlock();
-    raw_bucket_page->WUnlatch();
-    buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+
+  // A grown directory whose slots all point at the first bucket is still valid if a page runs out below.
+  BeginDirectoryUpdate();
+  bool is_grown = true;
+  while (is_grown && dir_page->GetGlobalDepth() < global_depth) {
+    is_grown = GrowDirectory(dir_page);
+  }
+  EndDirectoryUpdate();
+  if (!is_grown) {
+    return false;
+  }
+  // The new buckets are not reachable until the directory points at them, so they are filled without latches.
+  std::vector<page_id_t> bucket_page_ids(num_buckets);
+  bucket_page_ids[0] = dir_page->GetBucketPageId(0);
+  for (uint32_t bucket_idx = 1; bucket_idx < num_buckets; ++bucket_idx) {
+    Page *raw_bucket_page = buffer_pool_manager_->NewPage(&bucket_page_ids[bucket_idx]);
+    if (raw_bucket_page == nullptr) {
+      for (uint32_t i = 1; i < bucket_idx; ++i) {
+        buffer_pool_manager_->DeletePage(bucket_page_ids[i]);
+      }
+      overflow->clear();
+      *all_inserted = true;
+      return false;
+    }
+    fill_bucket(reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(raw_bucket_page->GetData()), bucket_idx);
+    buffer_pool_manager_->UnpinPage(bucket_page_ids[bucket_idx], true);
+  }
+  if (!PinDirectorySegments(dir_page)) {
+    for (uint32_t i = 1; i < num_buckets; ++i) {
+      buffer_pool_manager_->DeletePage(bucket_page_ids[i]);
+    }
+    overflow->clear();
+    *all_inserted = true;
+    return false;
+  }
+  fill_bucket(first_bucket_page, 0);
+  BeginDirectoryUpdate();
+  for (uint32_t bucket_idx = 0; bucket_idx < num_buckets; ++bucket_idx) {
+    [[maybe_unused]] bool is_set = SetSlot(dir_page, bucket_idx, global_depth, bucket_page_ids[bucket_idx]);
+    assert(is_set);
+  }
+  EndDirectoryUpdate();
+  UnpinDirectorySegments(dir_page);
+  return true;
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  auto dir_page = FetchDirectoryPage();
+  page_id_t bucket_page_id;
+  auto *raw_bucket_page = FetchLatchedBucketPage(key, dir_page, true, &bucket_page_id);
+  if (raw_bucket_page == nullptr) {
     buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+    return false;
+  }
+  uint32_t bucket_index = KeyToDirectoryIndex(key, dir_page);
+  auto *bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(raw_bucket_page->GetData());
+  bool remove_succeed = bucket_page->Remove(key, value, comparator_, KeyToFingerprint(key));
+  // Merging the image into this bucket may change the depths under us, so this only tells if a merge is worth trying.
+  uint32_t local_depth;
+  uint32_t image_local_depth;
+  bool try_merge = bucket_page->IsEmpty() && GetSlotLocalDepth(dir_page, bucket_index, &local_depth) &&
+                   local_depth > 0 &&
+                   GetSlotLocalDepth(dir_page, bucket_index ^ (1U << (local_depth - 1)), &image_local_depth) &&
+                   image_local_depth == local_depth;
+  raw_bucket_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  if (try_merge) {
+    Merge(transaction, key, value);
   }
   return remove_succeed;
 }
@@ -292,61 +760,76 @@ bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  table_latch_.WLock();
-  auto dir_page = FetchDirectoryPage();
+  Page *raw_dir_page = buffer_pool_manager_->FetchPage(directory_page_id_);
+  raw_dir_page->WLatch();
+  auto *dir_page = reinterpret_cast<HashTableDirectoryPage *>(raw_dir_page->GetData());
   page_id_t bucket_page_id = KeyToPageId(key, dir_page);
   uint32_t bucket_index = KeyToDirectoryIndex(key, dir_page);
-  auto *raw_bucket_page = buffer_pool_manager_->FetchPage(bucket_page_id);
+  auto *raw_bucket_page = bucket_page_id == INVALID_PAGE_ID ? nullptr : buffer_pool_manager_->FetchPage(bucket_page_id);
+  if (raw_bucket_page == nullptr) {
+    raw_dir_page->WUnlatch();
+    UnpinPage(directory_page_id_, false);
+    return;
+  }
   raw_bucket_page->WLatch();
   auto *bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(raw_bucket_page->GetData());
-  if (!bucket_page->IsEmpty() || !dir_page->GetLocalDepth(bucket_index)) {
+  uint32_t local_depth;
+  if (!bucket_page->IsEmpty() || !GetSlotLocalDepth(dir_page, bucket_index, &local_depth) || local_depth == 0) {
     raw_bucket_page->WUnlatch();
-    table_latch_.WUnlock();
+    raw_dir_page->WUnlatch();
     buffer_pool_manager_->UnpinPage(bucket_page_id, false);
-    buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+    buffer_pool_manager_->UnpinPage(directory_page_id_, false);
     return;
   }
-  uint32_t merge_index = dir_page->GetMergeImageIndex(bucket_index);
-  page_id_t merge_bucket_page_id = dir_page->GetBucketPageId(merge_index);
-  if (!bucket_page->IsEmpty() || !dir_page->GetGlobalDepth() || !dir_page->GetLocalDepth(bucket_index) ||
-      (dir_page->GetLocalDepth(bucket_index) != dir_page->GetLocalDepth(merge_index)) ||
-      (bucket_page_id == merge_bucket_page_id)) {
+  uint32_t merge_index = bucket_index ^ (1U << (local_depth - 1));
+  page_id_t merge_bucket_page_id = GetSlotBucketPageId(dir_page, merge_index);
+  uint32_t merge_local_depth;
+  if (!dir_page->GetGlobalDepth() || merge_bucket_page_id == INVALID_PAGE_ID ||
+      !GetSlotLocalDepth(dir_page, merge_index, &merge_local_depth) || (local_depth != merge_local_depth) ||
+      (bucket_page_id == merge_bucket_page_id) || !PinDirectorySegments(dir_page)) {
     raw_bucket_page->WUnlatch();
-    table_latch_.WUnlock();
+    raw_dir_page->WUnlatch();
     buffer_pool_manager_->UnpinPage(bucket_page_id, false);
-    buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+    buffer_pool_manager_->UnpinPage(directory_page_id_, false);
     return;
   }
-  dir_page->DecrLocalDepth(bucket_index);
-  dir_page->DecrLocalDepth(merge_index);
-  for (uint32_t i = 0; i < dir_page->Size(); ++i) {
-    if (dir_page->GetBucketPageId(i) == bucket_page_id) {
-      dir_page->SetBucketPageId(i, merge_bucket_page_id);
-      dir_page->SetLocalDepth(i, dir_page->GetLocalDepth(merge_index));
-    } else if (dir_page->GetBucketPageId(i) == merge_bucket_page_id) {
-      if (i != merge_index) {
-        dir_page->DecrLocalDepth(i);
-      }
-    }
+  // Only the emptied bucket needs to be latched: lookups that reach its image find the same entries afterwards.
+  // The two buckets have every 2^(local_depth - 1)-th slot from the lowest one, which all go to the image now.
+  BeginDirectoryUpdate();
+  uint32_t stride = 1U << (local_depth - 1);
+  for (uint32_t i = bucket_index & (stride - 1); i < dir_page->Size(); i += stride) {
+    [[maybe_unused]] bool is_set = SetSlot(dir_page, i, local_depth - 1, merge_bucket_page_id);
+    assert(is_set);
   }
-  if (dir_page->CanShrink()) {
+  bool can_shrink = CanShrinkDirectory(dir_page);
+  UnpinDirectorySegments(dir_page);
+  if (can_shrink) {
     dir_page->DecrGlobalDepth();
   }
+  EndDirectoryUpdate();
   raw_bucket_page->WUnlatch();
-  table_latch_.WUnlock();
-  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
-  buffer_pool_manager_->DeletePage(bucket_page_id);
-  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+  raw_dir_page->WUnlatch();
+  UnpinPage(bucket_page_id, false);
+  UnpinPage(directory_page_id_, true);
+  // A lookup that read the old mapping may still have the page pinned. It finds the directory changed and lets go,
+  // but it may have to wait for us on the directory first, so only retry a few times with backoff. If the page is
+  // still pinned after that, it stays allocated and unreachable rather than holding up the merge.
+  auto backoff = std::chrono::microseconds(1);
+  for (int attempt = 1; !buffer_pool_manager_->DeletePage(bucket_page_id) && attempt < MERGE_DELETE_ATTEMPTS;
+       ++attempt) {
+    std::this_thread::sleep_for(backoff);
+    backoff *= 2;
+  }
   Merge(transaction, key, value);
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_TYPE::TestInterface() {
+  VerifyIntegrity();
   HashTableDirectoryPage *dir_page = FetchDirectoryPage();
-  dir_page->VerifyIntegrity();
   uint32_t num_readable = 0;
   for (uint32_t i = 0; i < dir_page->Size(); ++i) {
-    page_id_t page_id = dir_page->GetBucketPageId(i);
+    page_id_t page_id = GetSlotBucketPageId(dir_page, i);
     auto raw_bucket_page = buffer_pool_manager_->FetchPage(page_id);
     auto bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(raw_bucket_page->GetData());
     bool is_empty = bucket_page->IsEmpty();
@@ -355,18 +838,19 @@ void HASH_TABLE_TYPE::TestInterface() {
     buffer_pool_manager_->UnpinPage(page_id, false);
   }
   LOG_DEBUG("num readable %u", num_readable);
-  assert(buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr));
+  UnpinPage(directory_page_id_, false);
 }
 /*****************************************************************************
  * GETGLOBALDEPTH - DO NOT TOUCH
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 uint32_t HASH_TABLE_TYPE::GetGlobalDepth() {
-  table_latch_.RLock();
-  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
+  Page *raw_dir_page = buffer_pool_manager_->FetchPage(directory_page_id_);
+  raw_dir_page->RLatch();
+  auto *dir_page = reinterpret_cast<HashTableDirectoryPage *>(raw_dir_page->GetData());
   uint32_t global_depth = dir_page->GetGlobalDepth();
-  assert(buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr));
-  table_latch_.RUnlock();
+  raw_dir_page->RUnlatch();
+  UnpinPage(directory_page_id_, false);
   return global_depth;
 }
 
@@ -375,11 +859,41 @@ uint32_t HASH_TABLE_TYPE::GetGlobalDepth() {
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_TYPE::VerifyIntegrity() {
-  table_latch_.RLock();
-  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
-  dir_page->VerifyIntegrity();
-  assert(buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr));
-  table_latch_.RUnlock();
+  Page *raw_dir_page = buffer_pool_manager_->FetchPage(directory_page_id_);
+  raw_dir_page->RLatch();
+  auto *dir_page = reinterpret_cast<HashTableDirectoryPage *>(raw_dir_page->GetData());
+  if (dir_page->Size() <= DIRECTORY_ARRAY_SIZE) {
+    dir_page->VerifyIntegrity();
+  } else {
+    // The invariants of HashTableDirectoryPage::VerifyIntegrity, over the segments of the directory.
+    std::unordered_map<page_id_t, uint32_t> page_id_to_count;
+    std::unordered_map<page_id_t, uint32_t> page_id_to_ld;
+    for (uint32_t i = 0; i < dir_page->Size(); ++i) {
+      page_id_t page_id = GetSlotBucketPageId(dir_page, i);
+      uint32_t local_depth;
+      if (page_id == INVALID_PAGE_ID || !GetSlotLocalDepth(dir_page, i, &local_depth)) {
+        LOG_WARN("Verify Integrity: can't fetch the directory segment of slot %u", i);
+        continue;
+      }
+      assert(local_depth <= dir_page->GetGlobalDepth());
+      ++page_id_to_count[page_id];
+      auto iter = page_id_to_ld.emplace(page_id, local_depth).first;
+      if (iter->second != local_depth) {
+        LOG_WARN("Verify Integrity: curr_local_depth: %u, old_local_depth %u, for page_id: %u", local_depth,
+                 iter->second, page_id);
+        assert(iter->second == local_depth);
+      }
+    }
+    for (const auto &[page_id, count] : page_id_to_count) {
+      uint32_t required_count = 1U << (dir_page->GetGlobalDepth() - page_id_to_ld[page_id]);
+      if (count != required_count) {
+        LOG_WARN("Verify Integrity: count: %u, required_count: %u, for page_id: %u", count, required_count, page_id);
+        assert(count == required_count);
+      }
+    }
+  }
+  raw_dir_page->RUnlatch();
+  UnpinPage(directory_page_id_, false);
 }
 
 /*****************************************************************************
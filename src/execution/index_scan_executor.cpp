@@ -15,7 +15,10 @@ namespace bustub {
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
     : AbstractExecutor(exec_ctx) {}
 
-void IndexScanExecutor::Init() {}
+void IndexScanExecutor::Init() {
+  // index lookups land on pages all over the table
+  exec_ctx_->GetBufferPoolManager()->AdviseAccessPattern(AccessPattern::RANDOM);
+}
 
 bool IndexScanExecutor::Next(Tuple *tuple, RID *rid) { return false; }
 
@@ -26,6 +26,7 @@ SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNod
       txn_(exec_ctx_->GetTransaction()) {}
 
 void SeqScanExecutor::Init() {
+  exec_ctx_->GetBufferPoolManager()->AdviseAccessPattern(AccessPattern::SEQUENTIAL);
   table_iterator_ = table_heap_->Begin(exec_ctx_->GetTransaction());
   table_iterator_end_ = table_heap_->End();
 }
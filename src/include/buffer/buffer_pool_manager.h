@@ -15,7 +15,9 @@
 #include <list>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
+#include "buffer/buffer_pool_stats.h"
 #include "buffer/lru_replacer.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
@@ -23,6 +25,9 @@
 
 namespace bustub {
 
+/** How a query is about to access pages, see BufferPoolManager::AdviseAccessPattern. */
+enum class AccessPattern { NORMAL, SEQUENTIAL, RANDOM };
+
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
  */
@@ -87,6 +92,52 @@ class BufferPoolManager {
   /** @return size of the buffer pool */
   virtual size_t GetPoolSize() = 0;
 
+  /**
+   * Hint that the pages [page_id, page_id + num_pages) will be fetched soon, so that the buffer pool can start reading
+   * them in the background. This never blocks on I/O and may be ignored.
+   * @param page_id id of the first page to read ahead
+   * @param num_pages number of consecutive page ids to read ahead
+   */
+  virtual void Prefetch(page_id_t page_id, size_t num_pages) {}
+
+  /**
+   * Hint how pages are about to be accessed, e.g. by a sequential scan or by index lookups. This may be ignored.
+   * @param access_pattern the access pattern
+   */
+  virtual void AdviseAccessPattern(AccessPattern access_pattern) {}
+
+  /**
+   * Fetch several pages at once. Each page that is returned is pinned, as if it had been fetched with FetchPage.
+   * @param page_ids ids of the pages to fetch
+   * @param[out] pages pages[i] is set to page page_ids[i], or nullptr if it could not be fetched
+   * @return the number of pages that were fetched
+   */
+  virtual size_t FetchPages(const std::vector<page_id_t> &page_ids, Page **pages) {
+    size_t num_fetched = 0;
+    for (size_t i = 0; i < page_ids.size(); ++i) {
+      pages[i] = FetchPgImp(page_ids[i]);
+      num_fetched += pages[i] != nullptr ? 1 : 0;
+    }
+    return num_fetched;
+  }
+
+  /**
+   * Unpin several pages at once, as if each of them had been unpinned with UnpinPage.
+   * @param page_ids ids of the pages to unpin
+   * @param is_dirty true if the pages should be marked as dirty, false otherwise
+   * @return false if any of the pages had a pin count of 0 before this call, true otherwise
+   */
+  virtual bool UnpinPages(const std::vector<page_id_t> &page_ids, bool is_dirty) {
+    bool unpinned = true;
+    for (page_id_t page_id : page_ids) {
+      unpinned = UnpinPgImp(page_id, is_dirty) && unpinned;
+    }
+    return unpinned;
+  }
+
+  /** @return a snapshot of the buffer pool's counters, all zero if the buffer pool does not count */
+  virtual BufferPoolStats GetStats() { return {}; }
+
  protected:
   /**
    * Grading function. Do not modify!
@@ -12,14 +12,24 @@
 
 #pragma once
 
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <list>
 #include <mutex>  // NOLINT
+#include <set>
+#include <shared_mutex>
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <unordered_set>
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/frame_arena.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_scheduler.h"
 #include "storage/page/page.h"
 
 namespace bustub {
@@ -34,8 +44,13 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param pool_size the size of the buffer pool
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy used to pick victim frames
+   * @param use_huge_pages back the frames with 2 MB huge pages
+   * @param max_pool_size the size Resize may grow the buffer pool to, 0 = pool_size
    */
-  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr);
+  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU, bool use_huge_pages = false,
+                            size_t max_pool_size = 0);
   /**
    * Creates a new BufferPoolManagerInstance.
    * @param pool_size the size of the buffer pool
@@ -43,9 +58,15 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param instance_index index of this BPI in the parallel BPM
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy used to pick victim frames
+   * @param use_huge_pages back the frames with 2 MB huge pages. The frames of instance instance_index are placed on NUMA
+   * node instance_index (modulo the number of nodes) either way.
+   * @param max_pool_size the size Resize may grow the buffer pool to, 0 = pool_size
    */
   BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
-                            DiskManager *disk_manager, LogManager *log_manager = nullptr);
+                            DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU, bool use_huge_pages = false,
+                            size_t max_pool_size = 0);
 
   /**
    * Destroys an existing BufferPoolManagerInstance.
@@ -55,14 +76,82 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /** @return size of the buffer pool */
   size_t GetPoolSize() override { return pool_size_; }
 
+  /** @return the size Resize may grow the buffer pool to */
+  size_t GetMaxPoolSize() const { return max_pool_size_; }
+
+  /**
+   * Change the number of frames while the buffer pool stays in use. Growing hands the new frames out right away.
+   * Shrinking stops handing out the frames at or beyond new_pool_size and takes their pages out of the page table, so
+   * that new fetches read them into the remaining frames. Each page is evicted (and written back if dirty) once the
+   * pins already held on it are released, and the memory of the frames goes back to the operating system. Shrinking
+   * blocks until then, so the caller must not hold pins on those pages itself.
+   * @param new_pool_size the new number of frames, between 1 and the maximum pool size
+   * @return false if new_pool_size is out of range, true otherwise
+   */
+  bool Resize(size_t new_pool_size);
+
   /** @return pointer to all the pages in the buffer pool */
   Page *GetPages() { return pages_; }
 
+  /** @return the memory holding the data of all the pages in the buffer pool */
+  FrameArena *GetFrameArena() { return frame_arena_; }
+
+  /**
+   * Queue the pages of [page_id, page_id + num_pages) that belong to this instance to be read into free or evictable
+   * frames by a background thread. Pages that were never allocated are skipped, and hints beyond pool_size_ queued
+   * pages are dropped.
+   * @param page_id id of the first page to read ahead
+   * @param num_pages number of consecutive page ids to read ahead
+   */
+  void Prefetch(page_id_t page_id, size_t num_pages) override;
+
+  /**
+   * Fetch several pages, taking the latch once for the hits and once for the misses. The misses are read from disk in
+   * a single batch.
+   * @param page_ids ids of the pages to fetch, all of which must belong to this instance
+   * @param[out] pages pages[i] is set to page page_ids[i], or nullptr if no frame was free for it or it could not be
+   * read
+   * @return the number of pages that were fetched
+   */
+  size_t FetchPages(const std::vector<page_id_t> &page_ids, Page **pages) override;
+
+  /**
+   * Unpin several pages under a single acquisition of the latch.
+   * @param page_ids ids of the pages to unpin
+   * @param is_dirty true if the pages should be marked as dirty, false otherwise
+   * @return false if any of the pages had a pin count of 0 before this call, true otherwise
+   */
+  bool UnpinPages(const std::vector<page_id_t> &page_ids, bool is_dirty) override;
+
+  /**
+   * Start a background thread that writes out dirty, unpinned pages every page_cleaner_interval, so that victims are
+   * usually clean by the time a fetch needs their frame. Does nothing if the cleaner is already running.
+   * @param dirty_ratio the cleaner stops writing once at most this fraction of the frames is dirty
+   * @param write_budget the maximum number of pages the cleaner writes out per round
+   */
+  void RunPageCleaner(double dirty_ratio, size_t write_budget);
+
+  /** Stop and join the page cleaner thread, if it is running. */
+  void StopPageCleaner();
+
+  /** @return the number of evictions whose victim was clean */
+  uint64_t GetCleanEvictions() const { return stats_.Get(BufferPoolCounter::CLEAN_EVICTIONS); }
+
+  /** @return the number of evictions whose victim had to be written back first */
+  uint64_t GetDirtyEvictions() const { return stats_.Get(BufferPoolCounter::DIRTY_EVICTIONS); }
+
+  /** @return a snapshot of the counters of this instance */
+  BufferPoolStats GetStats() override { return stats_.Collect(); }
+
+  /** @return the number of frames that are free or hold an evictable page, i.e. how many more pages could be pinned */
+  size_t GetNumAvailableFrames();
+
  protected:
   /**
    * Fetch the requested page from the buffer pool.
    * @param page_id id of page to be fetched
-   * @return the requested page
+   * @return the requested page, nullptr if no frame was free for it or it could not be read, e.g. because it does not
+   * match its checksum
    */
   Page *FetchPgImp(page_id_t page_id) override;
 
@@ -96,23 +185,169 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   bool DeletePgImp(page_id_t page_id) override;
 
   /**
-   * Flushes all the pages in the buffer pool to disk.
+   * Flushes all the pages in the buffer pool to disk, checkpoint style: the dirty pages are handed to the disk
+   * scheduler in batches, which writes each run of adjacent pages with one vectored write. Only a small batch of frames
+   * is held at a time, so fetches can keep evicting the others meanwhile. Pages that could not be written stay dirty.
    */
   void FlushAllPgsImp() override;
 
   /**
-   * Allocate a page on disk.∂
+   * Allocate a page on disk, reusing the lowest deallocated page of this instance if there is one. The caller must hold
+   * latch_ exclusively.
    * @return the id of the allocated page
    */
   page_id_t AllocatePage();
 
   /**
-   * Deallocate a page on disk.
+   * Deallocate a page on disk, so that AllocatePage hands it out again. The caller must hold latch_ exclusively.
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
-  }
+  void DeallocatePage(page_id_t page_id);
+
+  /** @return latch_, locked in shared mode. Time spent waiting for it is counted. */
+  std::shared_lock<std::shared_mutex> LatchShared();
+
+  /** @return latch_, locked exclusively. Time spent waiting for it is counted. */
+  std::unique_lock<std::shared_mutex> LatchExclusive();
+
+  /**
+   * Pin a resident frame. The caller must hold latch_ in at least shared mode.
+   * @param frame_id id of the frame to pin
+   * @return pointer to the page held in the frame
+   */
+  Page *PinFrame(frame_id_t frame_id);
+
+  /**
+   * Unpin a page. The caller must hold latch_ in at least shared mode.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @return false if the page pin count is <= 0 before this call, true otherwise
+   */
+  bool UnpinFrame(page_id_t page_id, bool is_dirty);
+
+  /**
+   * Pin a resident frame for the buffer pool's own I/O. Unlike PinFrame this leaves the frame's position in the
+   * replacer alone, so flushing a page does not make it look recently used. The caller must hold latch_ in at least
+   * shared mode.
+   * @param frame_id id of the frame to hold
+   */
+  void HoldFrame(frame_id_t frame_id);
+
+  /**
+   * Release a pin taken by HoldFrame.
+   * @param frame_id id of the frame to release
+   */
+  void ReleaseFrame(frame_id_t frame_id);
+
+  /**
+   * Write a held frame's page out if it is dirty. If the write fails, the page is marked dirty again.
+   * @param frame_id id of the frame, which the caller must hold
+   * @param[out] written set to true if the page was written, false otherwise
+   * @return false if the page was dirty but could not be written, true otherwise
+   */
+  bool FlushFrame(frame_id_t frame_id, bool *written);
+
+  /**
+   * Wait a while for a page to drain out of a frame that Resize removes, so that it can be read back in from disk. A
+   * fetch that waits too long, e.g. because its own thread still pins the page, takes the draining frame instead. The
+   * caller must hold latch_ exclusively, which is released while waiting.
+   * @param page_id id of the page
+   * @param exclusive_latch the caller's lock on latch_
+   * @param[out] frame_id the frame the page is draining out of, if it still is
+   * @return true if the page is still draining, false if it is not (any more)
+   */
+  bool WaitForDrain(page_id_t page_id, std::unique_lock<std::shared_mutex> *exclusive_latch, frame_id_t *frame_id);
+
+  /**
+   * Read a page that is not resident into a free or victim frame, pinned once. The caller must hold latch_
+   * exclusively and have checked that the page is not resident. The latch is released before any I/O.
+   * @param page_id id of the page to read in
+   * @param exclusive_latch the caller's lock on latch_
+   * @param[out] frame_id the frame the page was read into
+   * @return false if there is no frame for the page, or it could not be read
+   */
+  bool LoadPage(page_id_t page_id, std::unique_lock<std::shared_mutex> *exclusive_latch, frame_id_t *frame_id);
+
+  /** Body of the prefetch thread: reads queued pages in until the instance is destroyed. */
+  void PrefetchLoop();
+
+  /**
+   * Read a page in for the prefetch thread and leave it unpinned, unless it is already resident. The read is neither a
+   * hit nor a miss, and the replacer does not count it as an access.
+   * @param page_id id of the page to read in
+   */
+  void PrefetchPage(page_id_t page_id);
+
+  /** Body of the page cleaner thread. */
+  void PageCleanerLoop();
+
+  /**
+   * One page cleaner round: write out dirty, unpinned pages until the dirty ratio target or the write budget is met.
+   * @return the number of pages written
+   */
+  size_t CleanPages();
+
+  /**
+   * Find a frame that can hold a new page, taking it from the free list first and the replacer otherwise. If the
+   * victim is dirty it is registered as being written back, and the caller must call WriteBack once latch_ has been
+   * released. The victim's page table entry is removed. The caller must hold latch_ exclusively.
+   * @param[out] frame_id id of the frame that was found
+   * @param[out] write_back_page_id id of the dirty victim page, INVALID_PAGE_ID if nothing has to be written
+   * @return false if every frame is pinned, true otherwise
+   */
+  bool FindReplacementFrame(frame_id_t *frame_id, page_id_t *write_back_page_id);
+
+  /**
+   * Write a page out of a frame through the disk scheduler and wait for the write, timing it.
+   * @param frame_id id of the frame that holds the page's data
+   * @param page_id id of the page
+   * @return false if the page could not be written
+   */
+  bool WriteFrame(frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * Read a page into a frame through the disk scheduler and wait for the read, timing it.
+   * @param frame_id id of the frame to read into
+   * @param page_id id of the page
+   * @return false if the page could not be read
+   */
+  bool ReadFrame(frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * Start writing a victim page back. Its data is copied out of its old frame, so the frame can be reused right away,
+   * and the write completes in the background. Anyone waiting to read the page back in is woken up once it has.
+   * @param frame_id id of the frame that still holds the victim's data
+   * @param page_id id of the victim page
+   */
+  void WriteBack(frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * Block until page_id is no longer being written back by an eviction, so that reading it sees the latest data.
+   * @param page_id id of the page about to be read
+   */
+  void WaitForWriteBack(page_id_t page_id);
+
+  /**
+   * Block until the in-flight I/O on a frame has completed. The caller must hold a pin on the frame.
+   * @param frame_id id of the frame
+   * @return false if the page could not be read into the frame, in which case the caller must drop its pin with
+   * DropFailedFrame
+   */
+  bool WaitForFrameIO(frame_id_t frame_id);
+
+  /**
+   * Mark the in-flight I/O on a frame as completed and wake up its waiters.
+   * @param frame_id id of the frame
+   * @param success false if the page could not be read into the frame
+   */
+  void FinishFrameIO(frame_id_t frame_id, bool success);
+
+  /**
+   * Drop a pin on a frame whose page could not be read in. The first caller removes the page from the page table, so
+   * that the next fetch tries to read it again, and the last one returns the frame to the free list.
+   * @param frame_id id of the frame
+   */
+  void DropFailedFrame(frame_id_t frame_id);
 
   /**
    * Validate that the page_id being used is accessible to this BPI. This can be used in all of the functions to
@@ -121,8 +356,17 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   void ValidatePageId(page_id_t page_id) const;
 
-  /** Number of pages in the buffer pool. */
-  const size_t pool_size_;
+  /** Maximum number of frames FlushAllPgsImp holds at a time. */
+  static constexpr size_t FLUSH_BATCH_SIZE = 256;
+
+  /** Number of pages in the buffer pool. Frames at or beyond it are never handed out. */
+  std::atomic<size_t> pool_size_;
+  /** Number of frames the arena, the header table and the replacer are reserved for. */
+  const size_t max_pool_size_;
+  /** Number of frames whose Page and FrameHeader have been constructed. Protected by latch_. */
+  size_t num_frames_ = 0;
+  /** Serializes calls to Resize. */
+  std::mutex resize_latch_;
   /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
   const uint32_t num_instances_ = 1;
   /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
@@ -132,17 +376,73 @@ class BufferPoolManagerInstance : public BufferPoolManager {
 
   /** Array of buffer pool pages. */
   Page *pages_;
+  /** Cache-line-aligned table of the book-keeping of all frames, indexed by frame id. */
+  FrameHeader *frame_headers_;
+  /** Memory holding the data of the buffer pool pages. */
+  FrameArena *frame_arena_;
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
+  /** Carries out all page I/O of this instance, so that write-backs overlap with reads. */
+  DiskScheduler *disk_scheduler_;
   /** Pointer to the log manager. */
   LogManager *log_manager_ __attribute__((__unused__));
   /** Page table for keeping track of buffer pool pages. */
   std::unordered_map<page_id_t, frame_id_t> page_table_;
   /** Replacer to find unpinned pages for replacement. */
   Replacer *replacer_;
+  /** Deallocated pages of this instance, mirrored in the disk manager's free-page map. Protected by latch_. */
+  std::set<page_id_t> free_page_ids_;
   /** List of free pages. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
-  std::mutex latch_;
+  /**
+   * Pages that Resize took out of the page table while they were pinned, and the frames beyond the pool size they
+   * are still in. Unpins find them here. Protected by latch_.
+   */
+  std::unordered_map<page_id_t, frame_id_t> draining_pages_;
+  /**
+   * This latch protects page_table_, free_list_ and the frame a page id maps to. Fetching or unpinning a resident page
+   * only needs it in shared mode, since pin counts and dirty flags are atomic; bringing a page in, evicting or deleting
+   * one takes it exclusively. The replacer is only asked for victims while the latch is held exclusively. Disk I/O is
+   * never done while holding it: a frame being read into is marked io_pending_ and pinned until the read completes.
+   */
+  std::shared_mutex latch_;
+  /** Protects write_back_pages_ and the io_pending_ flags of the frames, and is the mutex io_cv_ waits on. */
+  std::mutex io_latch_;
+  /** Signalled whenever a frame's I/O or a victim's write-back completes. */
+  std::condition_variable io_cv_;
+  /**
+   * Ids of evicted pages whose write-back is still in flight, and of draining pages. They must not be read back in
+   * until the write-back completes.
+   */
+  std::unordered_set<page_id_t> write_back_pages_;
+
+  /** Hits, misses, evictions, waits and I/O latencies of this instance. */
+  BufferPoolStatsCollector stats_;
+
+  /** Prefetch thread, started by the first Prefetch call. */
+  std::thread *prefetch_thread_ = nullptr;
+  /** Protects prefetch_queue_ and stop_prefetch_, and is the mutex prefetch_cv_ waits on. */
+  std::mutex prefetch_latch_;
+  /** Signalled when pages are queued for prefetching or the instance shuts down. */
+  std::condition_variable prefetch_cv_;
+  /** Ids of the pages waiting to be prefetched. */
+  std::deque<page_id_t> prefetch_queue_;
+  /** True once the prefetch thread should exit. */
+  bool stop_prefetch_ = false;
+
+  /** Page cleaner thread, nullptr if the cleaner is not running. */
+  std::thread *cleaner_thread_ = nullptr;
+  /** Protects the cleaner settings below and is the mutex cleaner_cv_ waits on. */
+  std::mutex cleaner_latch_;
+  /** Signalled to stop the page cleaner. */
+  std::condition_variable cleaner_cv_;
+  /** True while the page cleaner should keep running. */
+  bool enable_page_cleaner_ = false;
+  /** Fraction of dirty frames the page cleaner aims to stay under. */
+  double cleaner_dirty_ratio_ = 0;
+  /** Maximum number of pages the page cleaner writes per round. */
+  size_t cleaner_write_budget_ = 0;
+  /** Frame the next page cleaner round starts scanning from. */
+  size_t cleaner_hand_ = 0;
 };
 }  // namespace bustub
@@ -0,0 +1,116 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.h
+//
+// Identification: src/include/buffer/buffer_pool_stats.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/** The events a buffer pool counts. */
+enum class BufferPoolCounter {
+  HITS,             // fetches that found their page resident
+  MISSES,           // fetches that had to read their page from disk
+  CLEAN_EVICTIONS,  // evictions whose victim was clean
+  DIRTY_EVICTIONS,  // evictions whose victim had to be written back first
+  PAGE_WRITES,      // pages written to disk, by write-backs, flushes and the page cleaner
+  PIN_WAITS,        // pins that had to wait for their page to come in from disk
+  LATCH_WAITS,      // acquisitions of the buffer pool latch that had to wait
+  LATCH_WAIT_NS,    // nanoseconds spent waiting for the buffer pool latch
+  NUM_COUNTERS
+};
+
+/**
+ * A snapshot of the counters of a buffer pool. I/O latencies are kept as histograms: bucket 0 counts the operations
+ * that took less than 2 microseconds, bucket i those that took [2^i, 2^(i+1)) microseconds, and the last bucket
+ * everything slower.
+ */
+struct BufferPoolStats {
+  static constexpr size_t NUM_LATENCY_BUCKETS = 16;
+
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+  uint64_t clean_evictions_ = 0;
+  uint64_t dirty_evictions_ = 0;
+  uint64_t page_writes_ = 0;
+  uint64_t pin_waits_ = 0;
+  uint64_t latch_waits_ = 0;
+  uint64_t latch_wait_ns_ = 0;
+  /** Latencies of page reads, from scheduling the read to its completion. */
+  std::array<uint64_t, NUM_LATENCY_BUCKETS> read_latency_{};
+  /** Latencies of page writes, from scheduling the write to its completion. */
+  std::array<uint64_t, NUM_LATENCY_BUCKETS> write_latency_{};
+
+  /** @return the fraction of fetches that found their page resident, 0 if there were none */
+  double HitRatio() const {
+    return hits_ + misses_ == 0 ? 0 : static_cast<double>(hits_) / static_cast<double>(hits_ + misses_);
+  }
+
+  /** Add the counters of other, e.g. to aggregate the stats of several buffer pools. */
+  BufferPoolStats &operator+=(const BufferPoolStats &other);
+
+  /** @return the histogram bucket a latency falls into */
+  static size_t LatencyBucket(std::chrono::nanoseconds latency);
+};
+
+/**
+ * BufferPoolStatsCollector counts the events of a buffer pool. The counters are sharded by thread, each shard on its
+ * own cache lines, so that threads counting hits concurrently do not contend. Counting is relaxed: a snapshot taken
+ * while the buffer pool is in use may be slightly behind.
+ */
+class BufferPoolStatsCollector {
+ public:
+  /** Add n to counter. */
+  void Add(BufferPoolCounter counter, uint64_t n = 1) {
+    LocalShard().counters_[static_cast<size_t>(counter)].fetch_add(n, std::memory_order_relaxed);
+  }
+
+  /** Record the latency of a disk read. */
+  void RecordRead(std::chrono::nanoseconds latency) {
+    LocalShard().read_latency_[BufferPoolStats::LatencyBucket(latency)].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /** Record the latency of a page write. */
+  void RecordWrite(std::chrono::nanoseconds latency) {
+    LocalShard().write_latency_[BufferPoolStats::LatencyBucket(latency)].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /** @return the value of counter, summed over the shards */
+  uint64_t Get(BufferPoolCounter counter) const;
+
+  /** @return a snapshot of all counters, summed over the shards */
+  BufferPoolStats Collect() const;
+
+ private:
+  static constexpr size_t NUM_SHARDS = 16;
+
+  struct alignas(CACHE_LINE_SIZE) Shard {
+    std::array<std::atomic<uint64_t>, static_cast<size_t>(BufferPoolCounter::NUM_COUNTERS)> counters_{};
+    std::array<std::atomic<uint64_t>, BufferPoolStats::NUM_LATENCY_BUCKETS> read_latency_{};
+    std::array<std::atomic<uint64_t>, BufferPoolStats::NUM_LATENCY_BUCKETS> write_latency_{};
+  };
+
+  /** @return the shard of the calling thread */
+  Shard &LocalShard() { return shards_[ShardIndex()]; }
+
+  /** @return the shard index of the calling thread, assigned round-robin when the thread first counts something */
+  static size_t ShardIndex();
+
+  std::array<Shard, NUM_SHARDS> shards_;
+};
+
+}  // namespace bustub
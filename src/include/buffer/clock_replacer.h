@@ -12,8 +12,8 @@
 
 #pragma once
 
-#include <list>
-#include <mutex>  // NOLINT
+#include <atomic>
+#include <cstdint>
 #include <vector>
 
 #include "buffer/replacer.h"
@@ -23,6 +23,10 @@ namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * Every frame has an atomic state byte holding an "in replacer" bit and a reference bit, and the clock hand is an
+ * atomic counter. Pin and Unpin are a single atomic read-modify-write each. They take no lock and never allocate, and
+ * Victim claims a frame with a compare-and-swap.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -43,10 +47,20 @@ class ClockReplacer : public Replacer {
 
   void Unpin(frame_id_t frame_id) override;
 
+  void UnpinPrefetched(frame_id_t frame_id) override;
+
   size_t Size() override;
 
  private:
-  // TODO(student): implement me!
+  /** Set while the frame can be victimized. */
+  static constexpr uint8_t IN_REPLACER = 1;
+  /** Set when the frame is unpinned and cleared when the clock hand passes it. */
+  static constexpr uint8_t REFERENCED = 2;
+
+  size_t num_pages_;
+  std::vector<std::atomic<uint8_t>> frame_states_;
+  std::atomic<size_t> clock_hand_{0};
+  std::atomic<size_t> size_{0};
 };
 
 }  // namespace bustub
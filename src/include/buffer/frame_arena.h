@@ -0,0 +1,77 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * FrameArena is the memory that holds the data of all frames of a buffer pool instance. It is a single anonymous
+ * mapping, so the frames are contiguous, page-aligned and zeroed. It can be backed by 2 MB huge pages to cut TLB misses
+ * on large pools, and it can be placed on a given NUMA node.
+ */
+class FrameArena {
+ public:
+  /**
+   * Map a new FrameArena.
+   * @param num_frames the number of PAGE_SIZE frames in the arena
+   * @param use_huge_pages back the arena with 2 MB huge pages: preallocated ones if the system has them, transparent
+   * huge pages otherwise
+   * @param numa_node the arena is placed on node numa_node modulo the number of NUMA nodes, -1 = no preference. Ignored
+   * if bustub was built without libnuma or the system is not NUMA.
+   */
+  FrameArena(size_t num_frames, bool use_huge_pages, int numa_node = -1);
+
+  /**
+   * Unmap the FrameArena.
+   */
+  ~FrameArena();
+
+  FrameArena(const FrameArena &other) = delete;
+  FrameArena &operator=(const FrameArena &other) = delete;
+
+  /** @return the data of frame frame_id */
+  inline char *GetFrame(frame_id_t frame_id) { return data_ + static_cast<size_t>(frame_id) * PAGE_SIZE; }
+
+  /**
+   * Give the memory of frames that are no longer used back to the operating system. The frames stay mapped and read as
+   * zeros when they are used again. Huge pages are only given back if the range covers them completely.
+   * @param frame_id the first frame to give back
+   * @param num_frames the number of frames to give back
+   */
+  void Discard(frame_id_t frame_id, size_t num_frames);
+
+  /** @return true if the arena is backed by huge pages */
+  inline bool IsHugePageBacked() const { return huge_pages_; }
+
+  /** @return the NUMA node the arena was placed on, -1 if it was not placed */
+  inline int GetNumaNode() const { return numa_node_; }
+
+ private:
+  /** Size of the huge pages the arena can be backed by. */
+  static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+  /** Start of the mapping. */
+  char *mapping_;
+  /** Length of the mapping in bytes. */
+  size_t mapping_size_;
+  /** Start of frame 0, aligned to HUGE_PAGE_SIZE if the arena is backed by transparent huge pages. */
+  char *data_;
+  bool huge_pages_{false};
+  int numa_node_{-1};
+};
+
+}  // namespace bustub
@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.h
+//
+// Identification: src/include/buffer/lru_k_replacer.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <mutex>  // NOLINT
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * Every Unpin of a frame that is not already evictable counts as one access. The victim is the frame whose K-th most
+ * recent access lies furthest in the past. Frames with fewer than K accesses count as infinitely far back and go
+ * first, oldest first access first. A page touched once by a large scan is therefore evicted before pages that are
+ * used again and again.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k the number of accesses remembered per frame
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = LRUK_REPLACER_K);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  void UnpinPrefetched(frame_id_t frame_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+ private:
+  /** Access history of one frame. */
+  struct FrameHistory {
+    /** Timestamps of the last (at most) k accesses, oldest first. */
+    std::deque<uint64_t> accesses_;
+    /** True if the frame is in one of the evictable sets. */
+    bool evictable_{false};
+    /** True if the only access is a placeholder left by UnpinPrefetched, which the first real access replaces. */
+    bool prefetched_{false};
+  };
+
+  /** @return the set that frame_id belongs to while it is evictable */
+  std::set<std::pair<uint64_t, frame_id_t>> *EvictableSet(const FrameHistory &history);
+
+  size_t num_pages_;
+  size_t k_;
+  uint64_t current_timestamp_{0};
+  std::vector<FrameHistory> frame_histories_;
+  /** Evictable frames with fewer than k accesses, ordered by their first access. */
+  std::set<std::pair<uint64_t, frame_id_t>> history_frames_;
+  /** Evictable frames with k accesses, ordered by their k-th most recent access. */
+  std::set<std::pair<uint64_t, frame_id_t>> cache_frames_;
+  std::mutex lru_k_replacer_latch_;
+};
+
+}  // namespace bustub
@@ -12,7 +12,8 @@
 
 #pragma once
 
-#include <mutex>  // NOLINT
+#include <atomic>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "buffer/buffer_pool_manager_instance.h"
@@ -30,9 +31,14 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    * @param pool_size the pool size of each BufferPoolManagerInstance
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy of every BufferPoolManagerInstance
+   * @param use_huge_pages back the frames of every BufferPoolManagerInstance with 2 MB huge pages. Instance i is placed
+   * on NUMA node i (modulo the number of nodes) either way.
+   * @param max_pool_size the size Resize may grow each BufferPoolManagerInstance to, 0 = pool_size
    */
   ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
-                            LogManager *log_manager = nullptr);
+                            LogManager *log_manager = nullptr, ReplacerType replacer_type = ReplacerType::LRU,
+                            bool use_huge_pages = false, size_t max_pool_size = 0);
 
   /**
    * Destroys an existing ParallelBufferPoolManager.
@@ -42,6 +48,65 @@ class ParallelBufferPoolManager : public BufferPoolManager {
   /** @return size of the buffer pool */
   size_t GetPoolSize() override;
 
+  /**
+   * Change the total number of frames, spreading them evenly over the BufferPoolManagerInstances. Shrinking blocks
+   * until the pages in the removed frames are unpinned, see BufferPoolManagerInstance::Resize.
+   * @param new_pool_size the new total number of frames
+   * @return false if an instance would end up empty or above its maximum size, true otherwise
+   */
+  bool Resize(size_t new_pool_size);
+
+  /**
+   * Pass a read-ahead hint on to every BufferPoolManagerInstance, each of which prefetches the pages it owns.
+   * @param page_id id of the first page to read ahead
+   * @param num_pages number of consecutive page ids to read ahead
+   */
+  void Prefetch(page_id_t page_id, size_t num_pages) override;
+
+  /**
+   * Fetch several pages, grouping them by the BufferPoolManagerInstance responsible for them, so that every instance
+   * handles its share as one batch.
+   * @param page_ids ids of the pages to fetch
+   * @param[out] pages pages[i] is set to page page_ids[i], or nullptr if it could not be fetched
+   * @return the number of pages that were fetched
+   */
+  size_t FetchPages(const std::vector<page_id_t> &page_ids, Page **pages) override;
+
+  /**
+   * Unpin several pages, grouping them by the BufferPoolManagerInstance responsible for them.
+   * @param page_ids ids of the pages to unpin
+   * @param is_dirty true if the pages should be marked as dirty, false otherwise
+   * @return false if any of the pages had a pin count of 0 before this call, true otherwise
+   */
+  bool UnpinPages(const std::vector<page_id_t> &page_ids, bool is_dirty) override;
+
+  /**
+   * Start a page cleaner on every BufferPoolManagerInstance.
+   * @param dirty_ratio the cleaners stop writing once at most this fraction of an instance's frames is dirty
+   * @param write_budget the maximum number of pages each cleaner writes out per round
+   */
+  void RunPageCleaner(double dirty_ratio, size_t write_budget);
+
+  /** Stop the page cleaner of every BufferPoolManagerInstance. */
+  void StopPageCleaner();
+
+  /** @return the number of evictions whose victim was clean, summed over all instances */
+  uint64_t GetCleanEvictions() const;
+
+  /** @return the number of evictions whose victim had to be written back first, summed over all instances */
+  uint64_t GetDirtyEvictions() const;
+
+  /** @return a snapshot of the counters, summed over all instances */
+  BufferPoolStats GetStats() override;
+
+  /**
+   * Turn rebalancing on or off. By default, a new page goes to the next instance in round-robin order, or to the
+   * calling thread's home instance if that one has more frames to spare. With rebalancing, a new page always goes to
+   * the instance with the most free or evictable frames, so that a hot instance is not thrashing while others idle.
+   * @param enable true to turn rebalancing on
+   */
+  void SetRebalancing(bool enable) { rebalancing_ = enable; }
+
  protected:
   /**
    * @param page_id id of page
@@ -86,17 +151,22 @@ class ParallelBufferPoolManager : public BufferPoolManager {
   bool DeletePgImp(page_id_t page_id) override;
 
   /**
-   * Flushes all the pages in the buffer pool to disk.
+   * Flushes all the pages in the buffer pool to disk, flushing the BufferPoolManagerInstances in parallel.
    */
   void FlushAllPgsImp() override;
 
+  /** @return index of the instance a new page should preferably be created in */
+  uint32_t PickAllocateInstance();
+
   uint32_t num_instances_;
   size_t pool_size_;
   DiskManager *disk_manager_;
   LogManager *log_manager_;
-  uint32_t allocate_index_;
+  /** Round-robin counter for picking instances to allocate from. Atomic, so that NewPgImp needs no latch. */
+  std::atomic<uint32_t> allocate_index_{0};
+  /** True if new pages always go to the instance with the most free or evictable frames. */
+  std::atomic<bool> rebalancing_{false};
   /** Represents buffer pool manager instances in parallel buffer pool manager. */
   BufferPoolManagerInstance **bpms_;
-  std::mutex latch_;
 };
 }  // namespace bustub
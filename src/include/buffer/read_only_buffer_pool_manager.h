@@ -0,0 +1,116 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_only_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/read_only_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ReadOnlyBufferPoolManager serves pages straight out of a read-only memory mapping of the database file, for replicas
+ * that never write. Fetching a page copies nothing: the page's data points into the mapping, and the operating system's
+ * page cache takes the place of the buffer pool's frames. The pin count of a page is a plain reference count, as a
+ * page is never evicted.
+ *
+ * The pages that exist are the ones in the file when the buffer pool is created. Writing to a page's data faults, and
+ * NewPage, DeletePage and unpinning a page as dirty fail. If the disk manager keeps checksums, a page is checked
+ * against its checksum the first time it is fetched, as the mapping goes around the disk manager's reads.
+ */
+class ReadOnlyBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new ReadOnlyBufferPoolManager over the pages in the disk manager's file.
+   * @param disk_manager the disk manager, which owns the mapping and the checksums
+   */
+  explicit ReadOnlyBufferPoolManager(DiskManager *disk_manager);
+
+  /**
+   * Destroys an existing ReadOnlyBufferPoolManager.
+   */
+  ~ReadOnlyBufferPoolManager() override;
+
+  /** @return the number of pages in the mapping */
+  size_t GetPoolSize() override { return num_pages_; }
+
+  /**
+   * Ask the operating system to read the pages [page_id, page_id + num_pages) into the page cache.
+   * @param page_id id of the first page to read ahead
+   * @param num_pages number of consecutive page ids to read ahead
+   */
+  void Prefetch(page_id_t page_id, size_t num_pages) override;
+
+  /**
+   * Pass the access pattern on to the operating system's read-ahead of the mapping.
+   * @param access_pattern the access pattern
+   */
+  void AdviseAccessPattern(AccessPattern access_pattern) override;
+
+ protected:
+  /**
+   * Fetch the requested page, pinning it.
+   * @param page_id id of page to be fetched
+   * @return the requested page, or nullptr if it is not in the mapping or does not match its checksum
+   */
+  Page *FetchPgImp(page_id_t page_id) override;
+
+  /**
+   * Unpin the target page.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty must be false, the buffer pool does not write
+   * @return false if the page pin count is <= 0 before this call or is_dirty is true, true otherwise
+   */
+  bool UnpinPgImp(page_id_t page_id, bool is_dirty) override;
+
+  /** Pages are never dirty. @return true if the page is in the mapping */
+  bool FlushPgImp(page_id_t page_id) override;
+
+  /** The buffer pool does not create pages. @return nullptr */
+  Page *NewPgImp(page_id_t *page_id) override;
+
+  /** The buffer pool does not delete pages. @return false if the page is in the mapping */
+  bool DeletePgImp(page_id_t page_id) override;
+
+  /** Pages are never dirty, so there is nothing to flush. */
+  void FlushAllPgsImp() override {}
+
+ private:
+  /** A page handed out over the mapping, created on the first fetch of the page. */
+  struct PageView {
+    PageView(page_id_t page_id, char *data);
+
+    FrameHeader header_;
+    Page page_;
+  };
+
+  /**
+   * @return the view of a page, creating it if needed, or nullptr if the page does not match its checksum; page_id
+   * must be in the mapping
+   */
+  PageView *GetView(page_id_t page_id);
+
+  DiskManager *disk_manager_;
+  /** Start of the mapping, owned by the disk manager. */
+  char *mapping_;
+  /** Number of pages in the mapping. */
+  page_id_t num_pages_;
+  /** Views by page id, nullptr until the page is first fetched. Views are installed without a latch. */
+  std::unique_ptr<std::atomic<PageView *>[]> views_;
+};
+
+}  // namespace bustub
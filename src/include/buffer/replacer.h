@@ -16,6 +16,9 @@
 
 namespace bustub {
 
+/** Replacement policies a buffer pool can be constructed with. */
+enum class ReplacerType { LRU, LRU_K, CLOCK };
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -43,6 +46,20 @@ class Replacer {
    */
   virtual void Unpin(frame_id_t frame_id) = 0;
 
+  /**
+   * Unpins a frame whose page was read in ahead of use, without counting that as an access to it. A replacer that
+   * orders frames only by when they were unpinned has nothing else to go by, so by default this is an Unpin.
+   * @param frame_id the id of the frame to unpin
+   */
+  virtual void UnpinPrefetched(frame_id_t frame_id) { Unpin(frame_id); }
+
+  /**
+   * Forgets a frame whose page has left the buffer pool, e.g. because the frame is reused for another page or the page
+   * was deleted. A replacer that keeps no history of the frame only has to stop tracking it.
+   * @param frame_id the id of the frame to forget
+   */
+  virtual void Remove(frame_id_t frame_id) { Pin(frame_id); }
+
   /** @return the number of elements in the replacer that can be victimized */
   virtual size_t Size() = 0;
 };
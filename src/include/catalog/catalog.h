@@ -217,12 +217,22 @@ class Catalog {
     auto index = std::make_unique<ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_,
                                                                                                hash_function);
 
-    // Populate the index with all tuples in table heap
+    // Populate the index with all tuples in table heap, a batch of keys at a time rather than one insert at a time.
+    // The first batch sizes the index's directory for the whole heap, so that every batch is loaded bucket by bucket.
     auto *table_meta = GetTable(table_name);
     auto *heap = table_meta->table_.get();
+    size_t num_tuples = heap->GetNumTupleSlots();
+    std::vector<std::pair<KeyType, ValueType>> entries;
     for (auto tuple = heap->Begin(txn); tuple != heap->End(); ++tuple) {
-      index->InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), txn);
+      KeyType index_key;
+      index_key.SetFromKey(tuple->KeyFromTuple(schema, key_schema, key_attrs));
+      entries.emplace_back(index_key, tuple->GetRid());
+      if (entries.size() == INDEX_BUILD_BATCH_SIZE) {
+        index->BulkLoad(entries, txn, num_tuples);
+        entries.clear();
+      }
     }
+    index->BulkLoad(entries, txn, num_tuples);
 
     // Get the next OID for the new index
     const auto index_oid = next_index_oid_.fetch_add(1);
@@ -327,6 +337,9 @@ class Catalog {
   [[maybe_unused]] LockManager *lock_manager_;
   [[maybe_unused]] LogManager *log_manager_;
 
+  /** Number of index entries CreateIndex holds in memory at a time while it populates a new index. */
+  static constexpr size_t INDEX_BUILD_BATCH_SIZE = 1 << 20;
+
   /**
    * Map table identifier -> table metadata.
    *
@@ -19,6 +19,7 @@
 #include <stdexcept>
 #include <string>
 
+#include "common/config.h"
 #include "type/type.h"
 
 namespace bustub {
@@ -47,6 +48,8 @@ enum class ExceptionType {
   OUT_OF_MEMORY = 9,
   /** Method not implemented. */
   NOT_IMPLEMENTED = 11,
+  /** A page read from disk does not match its checksum. */
+  PAGE_CORRUPTION = 12,
 };
 
 class Exception : public std::runtime_error {
@@ -98,6 +101,8 @@ class Exception : public std::runtime_error {
         return "Out of Memory";
       case ExceptionType::NOT_IMPLEMENTED:
         return "Not implemented";
+      case ExceptionType::PAGE_CORRUPTION:
+        return "Page corruption";
       default:
         return "Unknown";
     }
@@ -113,4 +118,18 @@ class NotImplementedException : public Exception {
   explicit NotImplementedException(const std::string &msg) : Exception(ExceptionType::NOT_IMPLEMENTED, msg) {}
 };
 
+class PageCorruptionException : public Exception {
+ public:
+  PageCorruptionException() = delete;
+  explicit PageCorruptionException(page_id_t page_id)
+      : Exception(ExceptionType::PAGE_CORRUPTION, "checksum mismatch on page " + std::to_string(page_id)),
+        page_id_(page_id) {}
+
+  /** @return the id of the corrupted page */
+  page_id_t GetPageId() const { return page_id_; }
+
+ private:
+  page_id_t page_id_;
+};
+
 }  // namespace bustub
@@ -0,0 +1,35 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// checksum_util.h
+//
+// Identification: src/include/common/util/checksum_util.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * ChecksumUtil computes checksums for detecting corrupted data.
+ */
+class ChecksumUtil {
+ public:
+  /**
+   * Compute the CRC32C (Castagnoli) checksum of a buffer, with the CPU's CRC instructions where the build target has
+   * them (SSE4.2 or ARMv8 CRC32) and with a lookup table otherwise.
+   * @param data the buffer
+   * @param length number of bytes in the buffer
+   * @return the checksum
+   */
+  static uint32_t Crc32c(const char *data, size_t length);
+};
+
+}  // namespace bustub
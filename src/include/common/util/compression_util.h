@@ -0,0 +1,47 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compression_util.h
+//
+// Identification: src/include/common/util/compression_util.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+namespace bustub {
+
+/**
+ * CompressionUtil is a fast byte-oriented LZ77 codec in the style of the LZ4 block format: a sequence of literal runs
+ * and back-references of at least four bytes into the previous 64 KB. It trades compression ratio for speed, which
+ * suits pages that are compressed on every write and decompressed on every read.
+ */
+class CompressionUtil {
+ public:
+  /**
+   * Compress a buffer.
+   * @param src the data to compress
+   * @param src_length number of bytes to compress
+   * @param[out] dst output buffer
+   * @param dst_capacity size of the output buffer
+   * @return the number of compressed bytes, or 0 if they do not fit into dst_capacity bytes
+   */
+  static size_t Compress(const char *src, size_t src_length, char *dst, size_t dst_capacity);
+
+  /**
+   * Decompress a buffer produced by Compress.
+   * @param src the compressed data
+   * @param src_length number of compressed bytes
+   * @param[out] dst output buffer
+   * @param dst_length the exact number of bytes the data decompresses to
+   * @return false if the compressed data is malformed or does not decompress to dst_length bytes
+   */
+  static bool Decompress(const char *src, size_t src_length, char *dst, size_t dst_length);
+};
+
+}  // namespace bustub
@@ -12,8 +12,10 @@
 
 #pragma once
 
+#include <atomic>
 #include <queue>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
@@ -75,6 +77,32 @@ class ExtendibleHashTable {
    */
   bool GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result);
 
+  /**
+   * Performs point queries for many keys at once. The directory is fetched once, the keys are grouped by the bucket
+   * they map to, and the buckets are fetched together, so that the reads of buckets not in the buffer pool overlap.
+   *
+   * @param transaction the current transaction
+   * @param keys the keys to look up
+   * @param[out] results results[i] gets the value(s) associated with keys[i] appended; resized to the number of keys
+   * @return the number of keys that have at least one value
+   */
+  size_t GetValues(Transaction *transaction, const std::vector<KeyType> &keys,
+                   std::vector<std::vector<ValueType>> *results);
+
+  /**
+   * Inserts many key-value pairs at once, bucket by bucket: every key is hashed first, and each bucket page is filled
+   * in one go without splits. An empty table has its directory grown up front to the depth that the expected number
+   * of pairs needs, so that pairs loaded in later batches are appended to the buckets already there. Pairs that don't
+   * fit in their bucket are inserted one by one.
+   *
+   * @param transaction the current transaction
+   * @param entries the key-value pairs to insert
+   * @param expected_num_entries the number of pairs that all batches of the load insert together, if more than these
+   * @return true if every pair was inserted, false if some were duplicates or could not be inserted
+   */
+  bool BulkLoad(Transaction *transaction, const std::vector<std::pair<KeyType, ValueType>> &entries,
+                size_t expected_num_entries = 0);
+
   /**
    * Returns the global depth.  Do not touch.
    */
@@ -95,6 +123,14 @@ class ExtendibleHashTable {
    */
   inline uint32_t Hash(KeyType key);
 
+  /**
+   * KeyToFingerprint - the fingerprint of a key that the bucket pages store next to it, see HashTableBucketPage
+   *
+   * @param key the key to fingerprint
+   * @return the key's fingerprint
+   */
+  inline uint8_t KeyToFingerprint(KeyType key);
+
   /**
    * KeyToDirectoryIndex - maps a key to a directory index
    *
@@ -137,6 +173,89 @@ class ExtendibleHashTable {
    */
   HASH_TABLE_BUCKET_TYPE *FetchBucketPage(page_id_t bucket_page_id);
 
+  /**
+   * Unpins a page that this hash table has pinned. The unpin is done in every build; only the check that the buffer
+   * pool manager had the page pinned is an assertion.
+   *
+   * @param page_id the page_id to unpin
+   * @param is_dirty whether the page was modified
+   */
+  void UnpinPage(page_id_t page_id, bool is_dirty);
+
+  /**
+   * Fetches the directory page that holds a slot: the directory page itself for the first DIRECTORY_ARRAY_SIZE slots,
+   * or one of the segment pages it lists.
+   *
+   * @param dir_page the directory page
+   * @param[in,out] bucket_idx the slot, which is turned into the index of the slot within the returned page
+   * @return the page, which is pinned unless it is dir_page, or nullptr if the buffer pool has no frame for it
+   */
+  HashTableDirectoryPage *FetchDirectorySegment(HashTableDirectoryPage *dir_page, uint32_t *bucket_idx);
+
+  /** Unpins a page returned by FetchDirectorySegment. */
+  void UnpinDirectorySegment(HashTableDirectoryPage *dir_page, HashTableDirectoryPage *segment, bool is_dirty);
+
+  /**
+   * Pins every segment page of the directory, so that the slot accessors below can't fail until they are unpinned.
+   *
+   * @param dir_page the directory page, latched for writing
+   * @return false, with nothing left pinned, if the buffer pool has no frame for one of them
+   */
+  bool PinDirectorySegments(HashTableDirectoryPage *dir_page);
+
+  /** Unpins the pages pinned by PinDirectorySegments. The directory must not have been resized in between. */
+  void UnpinDirectorySegments(HashTableDirectoryPage *dir_page);
+
+  /**
+   * @param dir_page the directory page
+   * @param bucket_idx the slot
+   * @param[out] local_depth the local depth of the slot
+   * @return false if the segment of the slot can't be fetched
+   */
+  bool GetSlotLocalDepth(HashTableDirectoryPage *dir_page, uint32_t bucket_idx, uint32_t *local_depth);
+
+  /** @return the bucket page id of a slot of the directory, or INVALID_PAGE_ID if its segment can't be fetched */
+  page_id_t GetSlotBucketPageId(HashTableDirectoryPage *dir_page, uint32_t bucket_idx);
+
+  /**
+   * Points a slot of the directory at a bucket.
+   *
+   * @return false if the segment of the slot can't be fetched
+   */
+  bool SetSlot(HashTableDirectoryPage *dir_page, uint32_t bucket_idx, uint32_t local_depth, page_id_t bucket_page_id);
+
+  /**
+   * Doubles the directory by copying its slots, allocating segment pages as they are needed. Segment pages are kept
+   * when the directory shrinks again, so a lookup that races with a shrink never reads a freed page.
+   *
+   * @param dir_page the directory page, latched for writing
+   * @return false if the directory is as large as it can be, or a segment page can't be allocated
+   */
+  bool GrowDirectory(HashTableDirectoryPage *dir_page);
+
+  /** @return true if no bucket has a local depth equal to the global depth, false also if a segment can't be fetched */
+  bool CanShrinkDirectory(HashTableDirectoryPage *dir_page);
+
+  /**
+   * Fetches and latches the bucket a key maps to, without latching the directory. Once the bucket is latched, the
+   * mapping is validated against directory_version_, and looked up again if a split or merge changed the directory in
+   * the meantime. A latched bucket cannot be split or merged, so the mapping stays valid until it is unlatched.
+   *
+   * @param key the key to look up
+   * @param dir_page the directory page, which the caller keeps pinned
+   * @param exclusive whether to latch the bucket for writing rather than for reading
+   * @param[out] bucket_page_id the page_id of the bucket
+   * @return the pinned and latched bucket page, or nullptr if the buffer pool has no frame for it
+   */
+  Page *FetchLatchedBucketPage(const KeyType &key, HashTableDirectoryPage *dir_page, bool exclusive,
+                               page_id_t *bucket_page_id);
+
+  /** Marks the start of a change to the directory, so that concurrent lookups retry. */
+  void BeginDirectoryUpdate();
+
+  /** Marks the end of a change to the directory. */
+  void EndDirectoryUpdate();
+
   /**
    * Performs insertion with an optional bucket splitting.
    *
@@ -147,6 +266,22 @@ class ExtendibleHashTable {
    */
   bool SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value);
 
+  /**
+   * Loads pairs bucket by bucket, see BulkLoad. An empty table gets its directory grown and its buckets created first,
+   * other tables get the pairs appended to the buckets their slots point at.
+   *
+   * @param dir_page the directory page, latched for writing
+   * @param first_bucket_page the bucket of slot 0, latched for writing, which stays the bucket of slot 0
+   * @param entries the key-value pairs to insert
+   * @param expected_num_entries the number of pairs to size the directory of an empty table for
+   * @param[out] overflow indexes of the pairs that did not fit in their bucket, left for Insert
+   * @param[out] all_inserted set to false if some pairs were duplicates
+   * @return false if the buffer pool ran out of pages while creating buckets, in which case no pair was inserted
+   */
+  bool LoadBuckets(HashTableDirectoryPage *dir_page, HASH_TABLE_BUCKET_TYPE *first_bucket_page,
+                   const std::vector<std::pair<KeyType, ValueType>> &entries, size_t expected_num_entries,
+                   std::vector<size_t> *overflow, bool *all_inserted);
+
   /**
    * Optionally merges an empty bucket into it's pair.  This is called by Remove,
    * if Remove makes a bucket empty.
@@ -162,13 +297,20 @@ class ExtendibleHashTable {
    */
   void Merge(Transaction *transaction, const KeyType &key, const ValueType &value);
 
+  /** Number of bucket pages GetValues fetches and keeps pinned at a time. */
+  static constexpr size_t GET_VALUES_BATCH_SIZE = 64;
+
+  /** Number of times Merge tries to delete an emptied bucket page that a lookup still has pinned. */
+  static constexpr int MERGE_DELETE_ATTEMPTS = 8;
+
   // member variables
   page_id_t directory_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
 
-  // Readers includes inserts and removes, writers are splits and merges
-  ReaderWriterLatch table_latch_;
+  // Inserts, removes and lookups only latch the bucket they work on. Splits and merges hold the directory page's write
+  // latch, which serializes them, and make the version odd while they change the directory.
+  std::atomic<uint64_t> directory_version_{0};
   HashFunction<KeyType> hash_fn_;
 };
 
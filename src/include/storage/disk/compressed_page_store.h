@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_store.h
+//
+// Identification: src/include/storage/disk/compressed_page_store.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * CompressedPageStore keeps pages compressed in the database file, each in a variable-sized extent, and maps page ids
+ * to their extents with an extent map kept in a file next to the database file. A page that does not compress is
+ * stored as is. Every write goes to a fresh extent, the best-fitting free one or the end of the file, and the page's
+ * map entry is switched over once the page is written, so a write cut short never damages the version the map points
+ * at. The old extent then becomes free and is merged with the free extents next to it.
+ *
+ * The database file of a CompressedPageStore is not a plain array of pages; it must always be opened compressed.
+ */
+class CompressedPageStore {
+ public:
+  /**
+   * Open the store.
+   * @param db_fd descriptor of the database file, which the store does not own
+   * @param map_file name of the extent map file, created if it does not exist
+   */
+  CompressedPageStore(int db_fd, const std::string &map_file);
+
+  ~CompressedPageStore();
+
+  CompressedPageStore(const CompressedPageStore &other) = delete;
+  CompressedPageStore &operator=(const CompressedPageStore &other) = delete;
+
+  /**
+   * Compress a page and write it to its extent.
+   * @return false on an I/O error
+   */
+  bool WritePage(page_id_t page_id, const char *page_data);
+
+  /**
+   * Read a page and decompress it. A page that was never written reads as zeros.
+   * @return false on an I/O error or if the stored page is malformed
+   */
+  bool ReadPage(page_id_t page_id, char *page_data);
+
+  /** @return one more than the highest id of a page in the store */
+  page_id_t GetNumPages();
+
+  /** @return the sum of the compressed sizes of all pages in the store */
+  uint64_t GetStoredBytes();
+
+ private:
+  /** Extents start at multiples of this many bytes, so that a freed extent fits pages of about the same size. */
+  static constexpr uint32_t EXTENT_ALIGNMENT = 256;
+
+  /** Where a page is stored, as kept in the extent map file. */
+  struct Extent {
+    uint64_t offset_;
+    /** Size of the compressed page, PAGE_SIZE if it is stored uncompressed, 0 if there is no page. */
+    uint32_t length_;
+    /** Size of the extent, a multiple of EXTENT_ALIGNMENT. */
+    uint32_t capacity_;
+  };
+
+  /** Take a free extent of at least capacity bytes. The caller holds latch_. */
+  Extent Allocate(uint32_t capacity);
+  /** Give an extent back, merging it with its free neighbours. The caller holds latch_. */
+  void Free(const Extent &extent);
+  /** Add to the free extents. The caller holds latch_. */
+  void AddFreeExtent(uint64_t offset, uint64_t capacity);
+  /** Remove from the free extents. The caller holds latch_. */
+  void RemoveFreeExtent(std::map<uint64_t, uint64_t>::iterator iter);
+  /** Record the extent of a page in memory and in the extent map file. The caller holds latch_. */
+  bool SetExtent(page_id_t page_id, const Extent &extent);
+
+  int db_fd_;
+  int map_fd_{-1};
+  /** Extents by page id. */
+  std::vector<Extent> extents_;
+  /** Free extents by capacity, for allocation. */
+  std::multimap<uint64_t, uint64_t> free_extents_;
+  /** The same free extents by offset, for merging. */
+  std::map<uint64_t, uint64_t> free_extents_by_offset_;
+  /** Where the file ends: all space past it is free. */
+  uint64_t end_offset_{0};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
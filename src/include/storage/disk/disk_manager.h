@@ -13,15 +13,48 @@
 #pragma once
 
 #include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstdlib>
 #include <fstream>
 #include <future>  // NOLINT
-#include <mutex>   // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <shared_mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
+#include "storage/disk/compressed_page_store.h"
+#include "storage/disk/io_ring.h"
 
 namespace bustub {
 
+/** How DiskManager carries out submitted page requests. */
+enum class DiskBackend {
+  SYNC,      // on the submitting thread with pread/pwrite
+  IO_URING,  // asynchronously through io_uring, or like SYNC where io_uring is not available
+};
+
+/**
+ * A page read or write submitted to DiskManager::SubmitRequests. The request and its buffer must stay alive until the
+ * request is done.
+ */
+struct DiskRequest {
+  /** True for a write, false for a read. */
+  bool is_write_{false};
+  page_id_t page_id_{INVALID_PAGE_ID};
+  /** The page to write, or the buffer to read into. */
+  char *data_{nullptr};
+  /** Set once the request has completed. */
+  std::atomic<bool> done_{false};
+  /** Valid once done_ is set: true if the request succeeded. Reads past the end of the file succeed with zeros. */
+  bool success_{false};
+  /** With checksums, the copy of the page that a write in flight on the ring writes, and the copy's checksum. */
+  std::unique_ptr<char[], decltype(&free)> stable_data_{nullptr, &free};
+  uint32_t checksum_{0};
+};
+
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
@@ -31,10 +64,23 @@ class DiskManager {
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param backend how submitted requests are carried out
+   * @param direct_io bypass the operating system's page cache with O_DIRECT, where the file system supports it
+   * @param checksums keep a CRC32C checksum of every page written and verify pages against it when they are read
+   * @param compression store pages compressed, see CompressedPageStore. Compressed pages are read and written
+   * synchronously through the page cache, whatever backend and direct_io say. A database file created compressed must
+   * be opened compressed and the other way round.
+   */
+  explicit DiskManager(const std::string &db_file, DiskBackend backend = DiskBackend::SYNC,
+                       bool direct_io = false, bool checksums = false, bool compression = false);
+
+  /**
+   * Releases the file resources if ShutDown was not called.
    */
-  explicit DiskManager(const std::string &db_file);
+  ~DiskManager();
 
-  ~DiskManager() = default;
+  DiskManager(const DiskManager &other) = delete;
+  DiskManager &operator=(const DiskManager &other) = delete;
 
   /**
    * Shut down the disk manager and close all the file resources.
@@ -42,19 +88,110 @@ class DiskManager {
   void ShutDown();
 
   /**
-   * Write a page to the database file.
+   * Write a page to the database file. Page reads and writes are positioned, so any number of threads can do them at
+   * the same time.
    * @param page_id id of the page
    * @param page_data raw page data
    */
   void WritePage(page_id_t page_id, const char *page_data);
 
+  /**
+   * Write a run of consecutive pages to the database file with as few system calls as possible.
+   * @param first_page_id id of the first page of the run
+   * @param pages the data of the pages first_page_id, first_page_id + 1, ...
+   * @return false if any of the pages could not be written, true otherwise
+   */
+  bool WritePages(page_id_t first_page_id, const std::vector<const char *> &pages);
+
   /**
    * Read a page from the database file.
    * @param page_id id of the page
    * @param[out] page_data output buffer
+   * @throws PageCorruptionException if checksums are on and the page does not match its checksum
    */
   void ReadPage(page_id_t page_id, char *page_data);
 
+  /**
+   * Read several pages from the database file in one go: they are submitted together in ascending page id order and
+   * read concurrently.
+   * @param pages ids of the pages and their output buffers
+   * @return false if any of the pages could not be read or does not match its checksum, true otherwise
+   */
+  bool ReadPages(std::vector<std::pair<page_id_t, char *>> pages);
+
+  /**
+   * Submit page requests without waiting for them. With the SYNC backend, or with O_DIRECT and a buffer that is not
+   * PAGE_SIZE aligned, a request is carried out before this returns.
+   * @param requests the requests, which must not be done_ yet
+   */
+  void SubmitRequests(const std::vector<DiskRequest *> &requests);
+
+  /**
+   * Block until a submitted request is done. Any thread may wait for any request.
+   * @param request the request to wait for
+   */
+  void WaitForRequest(DiskRequest *request);
+
+  /**
+   * Map the database file into memory, read-only. The mapping covers the whole pages of the file as it is now, leaving
+   * out a partial page at the end, and stays valid until the disk manager shuts down; mapping again returns the same
+   * mapping.
+   * @param[out] num_pages the number of pages the mapping covers
+   * @return the start of the mapping, nullptr if the file holds no whole page, is compressed or cannot be mapped
+   */
+  char *MapFile(page_id_t *num_pages);
+
+  /** @return true if submitted requests are carried out asynchronously through io_uring */
+  bool IsAsync() const { return ring_ != nullptr; }
+
+  /** @return true if the database file is accessed with O_DIRECT */
+  bool IsDirectIO() const { return direct_io_; }
+
+  /** @return true if pages are stored compressed */
+  bool IsCompressed() const { return compressed_store_ != nullptr; }
+
+  /** @return the number of bytes the pages take up in the database file, not counting free space */
+  uint64_t GetStoredBytes();
+
+  /** @return true if pages are checksummed */
+  bool HasChecksums() const { return checksums_; }
+
+  /** @return the number of page reads that did not match their checksum */
+  uint64_t GetNumChecksumFailures() const { return num_checksum_failures_; }
+
+  /**
+   * Check a page that was read without going through the disk manager, e.g. out of the mapping, against its checksum.
+   * @param page_id id of the page
+   * @param page_data the page as read
+   * @return false if checksums are on and the page does not match its checksum, true otherwise
+   */
+  bool VerifyChecksum(page_id_t page_id, const char *page_data);
+
+  /** @return the number of pages the database file spans */
+  page_id_t GetNumPages();
+
+  /**
+   * Mark a page as free in the free-page map, which is kept in a file next to the database file.
+   * @param page_id id of the deallocated page
+   */
+  void DeallocatePage(page_id_t page_id);
+
+  /**
+   * Mark a page that was free as in use again in the free-page map.
+   * @param page_id id of the reused page
+   */
+  void ReusePage(page_id_t page_id);
+
+  /** @return the ids of all pages the free-page map marks as free, in ascending order */
+  std::vector<page_id_t> GetFreePages();
+
+  /**
+   * Write the changes to the free-page map to its file. DeallocatePage and ReusePage only change the map in memory, so
+   * that the buffer pool can call them under its latch; the changes are written before the next page write, so a
+   * reused page never holds new data on disk while the map on disk still calls it free, and at shutdown.
+   */
+  void FlushFreePageMap();
+
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
@@ -80,6 +217,9 @@ class DiskManager {
   /** @return the number of disk writes */
   int GetNumWrites() const;
 
+  /** @return the number of disk reads */
+  int GetNumReads() const;
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -91,18 +231,96 @@ class DiskManager {
 
  private:
   int GetFileSize(const std::string &file_name);
+  /** Write a page, @return false on an I/O error */
+  bool WritePageData(page_id_t page_id, const char *page_data);
+  /** Read a page, @return false on an I/O error */
+  bool ReadPageData(page_id_t page_id, char *page_data);
+  /** Carry out a request on the calling thread and mark it done. */
+  void DoRequest(DiskRequest *request);
+  /**
+   * Mark the requests whose completions are in the ring as done. The caller must hold ring_latch_, and no thread may be
+   * waiting in the kernel: it could otherwise sleep on after its completion was taken.
+   * @return the number of requests marked as done
+   */
+  size_t ReapCompletions();
+  /**
+   * Submit what is queued and wait for completions, then reap them. Only one thread waits in the kernel, and it
+   * releases ring_latch_ while it does; any other thread just waits for it to be done.
+   * @param lock the caller's lock on ring_latch_
+   */
+  void AwaitCompletions(std::unique_lock<std::mutex> *lock);
+  /** Mark a request as done, given the number of bytes transferred or -errno. */
+  void FinishRequest(DiskRequest *request, ssize_t result);
+  /** Close the database file and tear down the ring, if that has not happened yet. */
+  void CloseDbFile();
+  /** Set or clear the bit of a page in the free-page map, and write the byte holding it through to the file. */
+  void SetPageFree(page_id_t page_id, bool is_free);
+  /**
+   * Record the checksums of a run of consecutive pages that were just written in the checksum file. The checksums are
+   * taken of the very buffers that were written, before writing them. Without checksums, this drops a checksum file
+   * that the write makes stale.
+   */
+  void StoreChecksums(page_id_t first_page_id, const uint32_t *checksums, size_t num_pages);
+  /** Grow the checksum file and its mapping to hold at least num_pages checksums. */
+  void GrowChecksumFile(size_t num_pages);
+
+  /** An entry of the checksum file. Any value is a valid CRC32C, so whether the page has one is kept beside it. */
+  struct ChecksumEntry {
+    uint32_t checksum_;
+    /** Nonzero if checksum_ is set; pages never written with checksums on have zeroed entries. */
+    uint32_t is_set_;
+  };
+
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // descriptor of the db file; pages are read and written with positioned I/O, so no latch is needed
+  int db_fd_{-1};
   std::string file_name_;
+  bool direct_io_{false};
   int num_flushes_;
-  int num_writes_;
+  std::atomic<int> num_writes_;
+  std::atomic<int> num_reads_;
   bool flush_log_;
   std::future<void> *flush_log_f_;
-  // With multiple buffer pool instances, need to protect file access
-  std::mutex db_io_latch_;
+  // read-only mapping of the db file made by MapFile, nullptr if there is none
+  char *mapping_{nullptr};
+  page_id_t mapped_pages_{0};
+  std::mutex mapping_latch_;
+  // the pages of a compressed db file, nullptr if the db file is a plain array of pages
+  CompressedPageStore *compressed_store_{nullptr};
+  // io_uring for submitted requests, nullptr if they are carried out synchronously
+  IORing *ring_{nullptr};
+  // serializes access to ring_, num_inflight_ and ring_waiting_
+  std::mutex ring_latch_;
+  // set while a thread waits in the kernel for completions, signalled once it has reaped them
+  bool ring_waiting_{false};
+  std::condition_variable ring_cv_;
+  // requests submitted to ring_ whose completions have not been reaped yet
+  size_t num_inflight_{0};
+  // stream to write the free-page map file, only opened once a page is deallocated
+  std::fstream fsm_io_;
+  std::string fsm_name_;
+  // one bit per page, set if the page is free
+  std::vector<uint8_t> free_page_map_;
+  // bytes of free_page_map_ changed since it was last written, and whether there are any
+  size_t fsm_dirty_begin_{0};
+  size_t fsm_dirty_end_{0};
+  std::atomic<bool> fsm_dirty_{false};
+  std::mutex fsm_latch_;
+  // checksum file next to the db file, one ChecksumEntry per page, mapped so that storing a checksum takes no system
+  // call. Checksums are stored after their pages are written, so a page write torn by a crash leaves a page that does
+  // not match its checksum.
+  bool checksums_{false};
+  int checksum_fd_{-1};
+  std::string checksum_name_;
+  // set while a checksum file exists that writes without checksums would make stale
+  std::atomic<bool> stale_checksum_file_{false};
+  ChecksumEntry *checksum_map_{nullptr};
+  size_t checksum_capacity_{0};
+  // shared to store and verify checksums, exclusive to grow the mapping
+  std::shared_mutex checksum_latch_;
+  std::atomic<uint64_t> num_checksum_failures_{0};
 };
 
 }  // namespace bustub
@@ -0,0 +1,126 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.h
+//
+// Identification: src/include/storage/disk/disk_scheduler.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <future>  // NOLINT
+#include <map>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * DiskScheduler sits between the buffer pool and the DiskManager. It queues page reads and writes and carries them out
+ * on a small pool of worker threads, so that callers can overlap I/O with other work. Each worker takes a batch of
+ * queued requests in ascending page id order, sweeping over the file like an elevator, writes runs of adjacent pages
+ * with one vectored write and submits the batch's reads together.
+ *
+ * Requests for the same page are carried out in the order they were scheduled only if they end up in the same batch.
+ * Callers that need a read to see an earlier write must wait for the write first.
+ */
+class DiskScheduler {
+ public:
+  /** Called with true if the request succeeded, false otherwise, on the worker thread that carried it out. */
+  using Callback = std::function<void(bool)>;
+
+  /**
+   * Creates a new DiskScheduler and starts its workers.
+   * @param disk_manager the disk manager that carries out the requests
+   * @param num_workers the number of worker threads
+   */
+  explicit DiskScheduler(DiskManager *disk_manager, size_t num_workers = DISK_SCHEDULER_WORKERS);
+
+  /**
+   * Carries out all requests that are still queued, then stops the workers.
+   */
+  ~DiskScheduler();
+
+  DiskScheduler(const DiskScheduler &other) = delete;
+  DiskScheduler &operator=(const DiskScheduler &other) = delete;
+
+  /**
+   * Schedule a page read.
+   * @param page_id id of the page to read
+   * @param data buffer to read into, which must stay alive until the read is done
+   * @param callback called when the read is done
+   */
+  void ScheduleRead(page_id_t page_id, char *data, Callback callback);
+
+  /**
+   * Schedule a page write.
+   * @param page_id id of the page to write
+   * @param data the page to write, which must stay alive and unchanged until the write is done
+   * @param callback called when the write is done
+   */
+  void ScheduleWrite(page_id_t page_id, const char *data, Callback callback);
+
+  /** Schedule a page read. @return a future that becomes ready with true once the read succeeded */
+  std::future<bool> ScheduleRead(page_id_t page_id, char *data);
+
+  /** Schedule a page write. @return a future that becomes ready with true once the write succeeded */
+  std::future<bool> ScheduleWrite(page_id_t page_id, const char *data);
+
+  /**
+   * Schedule several page writes at once, so that they are queued together.
+   * @param pages ids of the pages and their data
+   * @return one future per page, in the order of pages
+   */
+  std::vector<std::future<bool>> ScheduleWrites(const std::vector<std::pair<page_id_t, const char *>> &pages);
+
+  /** @return the number of vectored writes that wrote more than one page */
+  uint64_t GetNumMergedWrites() const { return num_merged_writes_; }
+
+ private:
+  /** Number of requests a worker takes off the queue at a time. */
+  static constexpr size_t BATCH_SIZE = 64;
+
+  struct Request {
+    bool is_write_;
+    char *data_;
+    Callback callback_;
+  };
+
+  /** Body of a worker thread. */
+  void WorkerLoop();
+
+  /**
+   * Carry out a batch of requests, which is sorted by page id.
+   * @param batch the requests and the ids of their pages
+   */
+  void RunBatch(std::vector<std::pair<page_id_t, Request>> *batch);
+
+  /** Queue a request and wake up a worker. */
+  void Enqueue(page_id_t page_id, Request request);
+
+  DiskManager *disk_manager_;
+  /** Queued requests by page id; requests for the same page stay in the order they were queued. */
+  std::multimap<page_id_t, Request> queue_;
+  /** Where the next batch starts taking requests from the queue. */
+  page_id_t next_page_id_{0};
+  bool stop_{false};
+  /** Protects queue_, next_page_id_ and stop_, and is the mutex cv_ waits on. */
+  std::mutex latch_;
+  /** Signalled when requests are queued or the scheduler shuts down. */
+  std::condition_variable cv_;
+  std::vector<std::thread> workers_;
+  std::atomic<uint64_t> num_merged_writes_{0};
+};
+
+}  // namespace bustub
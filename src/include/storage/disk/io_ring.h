@@ -0,0 +1,106 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_ring.h
+//
+// Identification: src/include/storage/disk/io_ring.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * IORing is a minimal io_uring submission and completion queue, talking to the kernel through the raw system calls.
+ * It is not thread-safe: the caller serializes all calls, except for Wait.
+ */
+class IORing {
+ public:
+  /**
+   * Set up a ring. If the kernel or the build does not support io_uring, the ring is left invalid.
+   * @param entries the number of submission queue entries, rounded up to a power of two by the kernel
+   */
+  explicit IORing(unsigned entries);
+
+  /**
+   * Tear the ring down. Requests still in flight complete in the kernel, but their completions are lost.
+   */
+  ~IORing();
+
+  IORing(const IORing &other) = delete;
+  IORing &operator=(const IORing &other) = delete;
+
+  /** @return true if the ring was set up and can be used */
+  inline bool IsValid() const { return ring_fd_ >= 0; }
+
+  /** @return the number of submission queue entries */
+  inline unsigned GetEntries() const { return sq_entries_; }
+
+  /**
+   * Queue a read, to be submitted by the next Enter.
+   * @return false if the submission queue is full
+   */
+  bool PrepareRead(int fd, char *buf, size_t len, off_t offset, uint64_t user_data);
+
+  /**
+   * Queue a write, to be submitted by the next Enter.
+   * @return false if the submission queue is full
+   */
+  bool PrepareWrite(int fd, const char *buf, size_t len, off_t offset, uint64_t user_data);
+
+  /**
+   * Submit the queued requests and wait until at least min_complete completions are available.
+   * @return the number of requests submitted, or -errno on failure
+   */
+  int Enter(unsigned min_complete);
+
+  /**
+   * Wait until at least min_complete completions are available, without submitting anything. This is the one call that
+   * may run concurrently with the others, so the caller does not have to serialize calls while it blocks.
+   * @return 0, or -errno on failure
+   */
+  int Wait(unsigned min_complete);
+
+  /**
+   * Take the oldest completion off the completion queue.
+   * @param[out] user_data the user_data the request was prepared with
+   * @param[out] result the result of the request: the number of bytes transferred, or -errno
+   * @return false if the completion queue is empty
+   */
+  bool PopCompletion(uint64_t *user_data, int *result);
+
+ private:
+  bool Prepare(uint8_t opcode, int fd, uint64_t addr, size_t len, off_t offset, uint64_t user_data);
+
+  int ring_fd_{-1};
+  unsigned sq_entries_{0};
+  /** Requests prepared but not yet submitted. */
+  unsigned to_submit_{0};
+
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  void *sqes_{nullptr};
+  size_t sqes_size_{0};
+
+  unsigned *sq_head_{nullptr};
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  void *cqes_{nullptr};
+};
+
+}  // namespace bustub
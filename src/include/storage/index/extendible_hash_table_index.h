@@ -15,6 +15,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "container/hash/extendible_hash_table.h"
@@ -39,6 +40,18 @@ class ExtendibleHashTableIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *results,
+                Transaction *transaction) override;
+
+  /**
+   * Inserts many entries into the index at once, bucket by bucket.
+   * @param entries the index keys and their values
+   * @param transaction the current transaction
+   * @param expected_num_entries the number of entries all batches of the load insert together, to size an empty index
+   */
+  void BulkLoad(const std::vector<std::pair<KeyType, ValueType>> &entries, Transaction *transaction,
+                size_t expected_num_entries = 0);
+
  protected:
   // comparator for key
   KeyComparator comparator_;
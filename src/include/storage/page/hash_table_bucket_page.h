@@ -31,7 +31,10 @@ namespace bustub {
  *
  *  Here '+' means concatenation.
  *  The above format omits the space required for the occupied_ and
- *  readable_ arrays. More information is in storage/page/hash_table_page_defs.h.
+ *  readable_ arrays and for fingerprints_, which hold one byte of each key's
+ *  hash. Lookups compare the fingerprints of many slots at a time and compare
+ *  full keys only where the fingerprint matches. More information is in
+ *  storage/page/hash_table_page_defs.h.
  *
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
@@ -40,12 +43,19 @@ class HashTableBucketPage {
   // Delete all constructor / destructor to ensure memory safety
   HashTableBucketPage() = delete;
 
+  /**
+   * @param hash the 64-bit hash of a key
+   * @return the fingerprint of the key, the top byte of the hash, which the directory index never reaches
+   */
+  static inline uint8_t HashToFingerprint(uint64_t hash) { return static_cast<uint8_t>(hash >> 56); }
+
   /**
    * Scan the bucket and collect values that have the matching key
    *
+   * @param fingerprint the fingerprint the key was inserted with
    * @return true if at least one key matched
    */
-  bool GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result);
+  bool GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result, uint8_t fingerprint);
 
   /**
    * Attempts to insert a key and value in the bucket.  Uses the occupied_
@@ -53,16 +63,18 @@ class HashTableBucketPage {
    *
    * @param key key to insert
    * @param value value to insert
+   * @param fingerprint the fingerprint of the key, which lookups of the key must pass as well
    * @return true if inserted, false if duplicate KV pair or bucket is full
    */
-  bool Insert(KeyType key, ValueType value, KeyComparator cmp);
+  bool Insert(KeyType key, ValueType value, KeyComparator cmp, uint8_t fingerprint);
 
   /**
    * Removes a key and value.
    *
+   * @param fingerprint the fingerprint the key was inserted with
    * @return true if removed, false if not found
    */
-  bool Remove(KeyType key, ValueType value, KeyComparator cmp);
+  bool Remove(KeyType key, ValueType value, KeyComparator cmp, uint8_t fingerprint);
 
   /**
    * Gets the key at an index in the bucket.
@@ -80,6 +92,14 @@ class HashTableBucketPage {
    */
   ValueType ValueAt(uint32_t bucket_idx) const;
 
+  /**
+   * Gets the fingerprint at an index in the bucket.
+   *
+   * @param bucket_idx the index in the bucket to get the fingerprint at
+   * @return fingerprint at index bucket_idx of the bucket
+   */
+  uint8_t FingerprintAt(uint32_t bucket_idx) const;
+
   /**
    * Remove the KV pair at bucket_idx
    */
@@ -138,10 +158,18 @@ class HashTableBucketPage {
   void PrintBucket();
 
  private:
+  /**
+   * Calls visit with the index of every readable slot whose fingerprint matches, until it returns true.
+   * @return true if visit returned true
+   */
+  template <typename Visitor>
+  bool ForEachCandidate(uint8_t fingerprint, Visitor visit) const;
+
   //  For more on BUCKET_ARRAY_SIZE see storage/page/hash_table_page_defs.h
   char occupied_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
   // 0 if tombstone/brand new (never occupied), 1 otherwise.
   char readable_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
+  uint8_t fingerprints_[BUCKET_ARRAY_SIZE];
   MappingType array_[0];
 };
 
@@ -26,19 +26,45 @@ namespace bustub {
  *
  * Directory Page for extendible hash table.
  *
- * Directory format (size in byte):
- * --------------------------------------------------------------------------------------------
- * | LSN (4) | PageId(4) | GlobalDepth(4) | LocalDepths(512) | BucketPageIds(2048) | Free(1524)
- * --------------------------------------------------------------------------------------------
+ * Directory format (size in byte, with N = DIRECTORY_ARRAY_SIZE = PAGE_SIZE / 8, 512 for 4 KB pages, and
+ * M = DIRECTORY_MAX_PAGES = PAGE_SIZE / 16):
+ * --------------------------------------------------------------------------------------------------------------
+ * | LSN (4) | PageId(4) | GlobalDepth(4) | LocalDepths(N) | BucketPageIds(4 * N) | SegmentPageIds(4 * M) | Free(...)
+ * --------------------------------------------------------------------------------------------------------------
+ *
+ * A directory of more than N slots continues on segment pages, which are laid out the same way but only use their
+ * local depths and bucket page ids: slot i is slot i % N of segment i / N, where segment 0 is this page itself.
+ * The methods that take a bucket index address the slots of this page, so the ones that look at the whole directory
+ * (Size, CanShrink, VerifyIntegrity and PrintDirectory) only work on a directory of at most N slots.
+ *
+ * The hash table looks keys up without latching the directory, while a split or merge may be changing it, and
+ * validates what it read afterwards. So the depths and bucket page ids are read and written with relaxed atomic
+ * operations, which never return a torn value.
  */
 class HashTableDirectoryPage {
  public:
   /**
-   * Init the global_depth_ to 1 when we create HashTableDirectoryPage
+   * Init the global_depth_ to 0 and clear the list of segment pages when we create HashTableDirectoryPage
    *
    */
   void Init();
 
+  /**
+   * Gets the page id of a segment page.
+   *
+   * @param segment_idx the index of the segment, from 1 to DIRECTORY_MAX_PAGES - 1
+   * @return the page id of the segment, or INVALID_PAGE_ID if it has not been allocated yet
+   */
+  page_id_t GetSegmentPageId(uint32_t segment_idx);
+
+  /**
+   * Sets the page id of a segment page.
+   *
+   * @param segment_idx the index of the segment, from 1 to DIRECTORY_MAX_PAGES - 1
+   * @param segment_page_id the page id of the segment
+   */
+  void SetSegmentPageId(uint32_t segment_idx, page_id_t segment_page_id);
+
   /**
    * @return the page ID of this page
    */
@@ -205,6 +231,9 @@ class HashTableDirectoryPage {
   uint32_t global_depth_{0};
   uint8_t local_depths_[DIRECTORY_ARRAY_SIZE];
   page_id_t bucket_page_ids_[DIRECTORY_ARRAY_SIZE];
+  page_id_t segment_page_ids_[DIRECTORY_MAX_PAGES];
 };
 
+static_assert(sizeof(HashTableDirectoryPage) <= PAGE_SIZE, "the directory must fit in a page");
+
 }  // namespace bustub
@@ -32,13 +32,28 @@
  * Extendible Hashing Definitions
  */
 #define HASH_TABLE_BUCKET_TYPE HashTableBucketPage<KeyType, ValueType, KeyComparator>
-#define DIRECTORY_ARRAY_SIZE 512
+
+/**
+ * DIRECTORY_ARRAY_SIZE is the number of bucket slots in the directory page. Each slot takes a one-byte local depth and
+ * a four-byte bucket page id, so PAGE_SIZE / 8 slots (512 at 4 KB) fill the page as far as a power of two can.
+ */
+#define DIRECTORY_ARRAY_SIZE (PAGE_SIZE / 8)
+
+/**
+ * DIRECTORY_MAX_PAGES is the number of pages a directory spans at most: the directory page, which holds the first
+ * DIRECTORY_ARRAY_SIZE slots, and the segment pages it lists, which hold DIRECTORY_ARRAY_SIZE slots each. The list
+ * takes PAGE_SIZE / 4 bytes of the directory page, which is the largest power of two that fits next to its own slots.
+ */
+#define DIRECTORY_MAX_PAGES (PAGE_SIZE / 16)
+
+/** DIRECTORY_MAX_SIZE is the number of slots of the largest directory, 2^17 with 4 KB pages. */
+#define DIRECTORY_MAX_SIZE (DIRECTORY_ARRAY_SIZE * DIRECTORY_MAX_PAGES)
 
 /**
  * BUCKET_ARRAY_SIZE is the number of (key, value) pairs that can be stored in an extendible hashing bucket page.
  * It is an approximate calculation based on the size of MappingType (which is a std::pair of KeyType and ValueType).
- * For each key/value pair, we need two additional bits for occupied_ and readable_. 4 * (PAGE_SIZE - 4) / (4 * sizeof
- * (MappingType) + 1) = (PAGE_SIZE - 4)/(sizeof (MappingType) + 0.25) because 0.25 bytes = 2 bits is the space required
- * to maintain the occupied and readable flags for a key value pair.
+ * For each key/value pair, we need a one-byte fingerprint and two additional bits for occupied_ and readable_.
+ * 4 * PAGE_SIZE / (4 * (sizeof (MappingType) + 1) + 1) = PAGE_SIZE / (sizeof (MappingType) + 1.25) because 0.25 bytes
+ * = 2 bits is the space required to maintain the occupied and readable flags for a key value pair.
  */
-#define BUCKET_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+#define BUCKET_ARRAY_SIZE (4 * PAGE_SIZE / (4 * (sizeof(MappingType) + 1) + 1))
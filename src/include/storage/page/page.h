@@ -12,17 +12,39 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <memory>
 
 #include "common/config.h"
 #include "common/rwlatch.h"
 
 namespace bustub {
 
+/**
+ * FrameHeader is the book-keeping of a page that the buffer pool manager reads when it scans frames. The buffer pool
+ * manager keeps the headers of all its frames in a dense table apart from the page data, so a scan over them touches
+ * four frames per cache line instead of one frame per page of memory.
+ */
+struct alignas(16) FrameHeader {
+  /** The ID of the page in the frame. */
+  page_id_t page_id_ = INVALID_PAGE_ID;
+  /** The pin count of the page. Atomic so that resident pages can be pinned without the buffer pool latch. */
+  std::atomic<int> pin_count_{0};
+  /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
+  std::atomic<bool> is_dirty_{false};
+  /** True while the buffer pool is reading the page in (or writing out the frame's previous page). */
+  std::atomic<bool> io_pending_{false};
+  /** True if the last read into the frame failed, so that it holds no page. Valid once io_pending_ is clear. */
+  std::atomic<bool> io_failed_{false};
+};
+
+static_assert(CACHE_LINE_SIZE % sizeof(FrameHeader) == 0);
+
 /**
  * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
- * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
+ * held in main memory. Page also refers to book-keeping information that is used by the buffer pool manager, e.g.
  * pin count, dirty flag, page id, etc.
  */
 class Page {
@@ -30,8 +52,21 @@ class Page {
   friend class BufferPoolManagerInstance;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor. Allocates a header and page data owned by this page and zeros out the data. */
+  Page()
+      : owned_header_(new FrameHeader()),
+        owned_data_(new char[PAGE_SIZE]),
+        header_(owned_header_.get()),
+        data_(owned_data_.get()) {
+    ResetMemory();
+  }
+
+  /**
+   * Constructor for a buffer pool frame.
+   * @param header the frame's entry in the buffer pool's header table, which must outlive the page
+   * @param data PAGE_SIZE bytes of zeroed frame memory, which must outlive the page
+   */
+  Page(FrameHeader *header, char *data) : header_(header), data_(data) {}
 
   /** Default destructor. */
   ~Page() = default;
@@ -40,13 +75,13 @@ class Page {
   inline char *GetData() { return data_; }
 
   /** @return the page id of this page */
-  inline page_id_t GetPageId() { return page_id_; }
+  inline page_id_t GetPageId() { return header_->page_id_; }
 
   /** @return the pin count of this page */
-  inline int GetPinCount() { return pin_count_; }
+  inline int GetPinCount() { return header_->pin_count_.load(); }
 
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
-  inline bool IsDirty() { return is_dirty_; }
+  inline bool IsDirty() { return header_->is_dirty_.load(); }
 
   /** Acquire the page write latch. */
   inline void WLatch() { rwlatch_.WLock(); }
@@ -78,14 +113,14 @@ class Page {
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
 
+  /** Header allocated by the page itself, nullptr if the header lives in a buffer pool's header table. */
+  std::unique_ptr<FrameHeader> owned_header_;
+  /** Page data allocated by the page itself, nullptr if the data lives in a buffer pool frame. */
+  std::unique_ptr<char[]> owned_data_;
+  /** The book-keeping information of this page. */
+  FrameHeader *header_;
   /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE]{};
-  /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
-  /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  char *data_;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
 };
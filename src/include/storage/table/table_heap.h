@@ -108,6 +108,12 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  /**
+   * Count the tuple slots of the table's pages, reading only the page headers.
+   * @return the number of tuple slots, an upper bound on the number of tuples as deleted tuples keep their slots
+   */
+  size_t GetNumTupleSlots();
+
  private:
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
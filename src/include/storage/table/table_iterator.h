@@ -32,7 +32,10 @@ class TableIterator {
   TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
 
   TableIterator(const TableIterator &other)
-      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {}
+      : table_heap_(other.table_heap_),
+        tuple_(new Tuple(*other.tuple_)),
+        txn_(other.txn_),
+        readahead_end_(other.readahead_end_) {}
 
   ~TableIterator() { delete tuple_; }
 
@@ -52,15 +55,25 @@ class TableIterator {
     table_heap_ = other.table_heap_;
     *tuple_ = *other.tuple_;
     txn_ = other.txn_;
+    readahead_end_ = other.readahead_end_;
     return *this;
   }
 
   RID GetTupleRid() { return tuple_->rid_; }
 
  private:
+  /**
+   * Ask the buffer pool to read ahead of the scan if it has just moved to the page that follows the previous one.
+   * @param prev_page_id id of the page the scan is leaving
+   * @param page_id id of the page the scan is moving to
+   */
+  void ReadAhead(page_id_t prev_page_id, page_id_t page_id);
+
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  /** One past the last page id already handed to Prefetch, INVALID_PAGE_ID if the scan is not sequential. */
+  page_id_t readahead_end_ = INVALID_PAGE_ID;
 };
 
 }  // namespace bustub
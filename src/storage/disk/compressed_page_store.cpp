@@ -0,0 +1,243 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_store.cpp
+//
+// Identification: src/storage/disk/compressed_page_store.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/compressed_page_store.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/util/compression_util.h"
+
+namespace bustub {
+
+/** Write all of buf at offset, retrying short writes. @return false on an I/O error */
+static bool WriteFully(int fd, const char *buf, size_t size, off_t offset) {
+  size_t written = 0;
+  while (written < size) {
+    ssize_t result = pwrite(fd, buf + written, size - written, offset + written);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      return false;
+    }
+    written += result;
+  }
+  return true;
+}
+
+/** Read all of buf from offset, retrying short reads. @return false on an I/O error or at the end of the file */
+static bool ReadFully(int fd, char *buf, size_t size, off_t offset) {
+  size_t read_count = 0;
+  while (read_count < size) {
+    ssize_t result = pread(fd, buf + read_count, size - read_count, offset + read_count);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      return false;
+    }
+    read_count += result;
+  }
+  return true;
+}
+
+CompressedPageStore::CompressedPageStore(int db_fd, const std::string &map_file) : db_fd_(db_fd) {
+  map_fd_ = open(map_file.c_str(), O_RDWR | O_CREAT, 0644);
+  if (map_fd_ < 0) {
+    throw Exception("can't open extent map file");
+  }
+  struct stat stat_buf;
+  if (fstat(map_fd_, &stat_buf) != 0) {
+    throw Exception("can't read extent map file");
+  }
+  extents_.resize(stat_buf.st_size / sizeof(Extent));
+  if (!extents_.empty() && !ReadFully(map_fd_, reinterpret_cast<char *>(extents_.data()),
+                                      extents_.size() * sizeof(Extent), 0)) {
+    throw Exception("can't read extent map file");
+  }
+
+  // everything between the extents in use is free
+  std::vector<std::pair<uint64_t, uint32_t>> used;
+  for (const auto &extent : extents_) {
+    if (extent.length_ != 0) {
+      used.emplace_back(extent.offset_, extent.capacity_);
+    }
+  }
+  std::sort(used.begin(), used.end());
+  for (const auto &[offset, capacity] : used) {
+    if (offset > end_offset_) {
+      AddFreeExtent(end_offset_, offset - end_offset_);
+    }
+    end_offset_ = offset + capacity;
+  }
+}
+
+CompressedPageStore::~CompressedPageStore() { close(map_fd_); }
+
+bool CompressedPageStore::WritePage(page_id_t page_id, const char *page_data) {
+  thread_local char compressed[PAGE_SIZE];
+  // a page that saves less than an extent's alignment is not worth decompressing
+  size_t length = CompressionUtil::Compress(page_data, PAGE_SIZE, compressed, PAGE_SIZE - EXTENT_ALIGNMENT);
+  const char *stored = compressed;
+  if (length == 0) {
+    stored = page_data;
+    length = PAGE_SIZE;
+  }
+  uint32_t capacity = (length + EXTENT_ALIGNMENT - 1) / EXTENT_ALIGNMENT * EXTENT_ALIGNMENT;
+
+  Extent extent;
+  {
+    std::scoped_lock latch(latch_);
+    extent = Allocate(capacity);
+  }
+  extent.length_ = static_cast<uint32_t>(length);
+
+  // write the page before its new extent is recorded, so that the map never points at a page not written yet
+  bool success = WriteFully(db_fd_, stored, length, static_cast<off_t>(extent.offset_));
+  std::scoped_lock latch(latch_);
+  if (!success) {
+    LOG_DEBUG("I/O error while writing");
+    Free(extent);
+    return false;
+  }
+  Extent old_extent{0, 0, 0};
+  if (static_cast<size_t>(page_id) < extents_.size()) {
+    old_extent = extents_[page_id];
+  }
+  if (!SetExtent(page_id, extent)) {
+    // the map file may point at either extent now, so neither can be reused
+    return false;
+  }
+  if (old_extent.length_ != 0) {
+    Free(old_extent);
+  }
+  return true;
+}
+
+bool CompressedPageStore::ReadPage(page_id_t page_id, char *page_data) {
+  Extent extent{0, 0, 0};
+  {
+    std::scoped_lock latch(latch_);
+    if (static_cast<size_t>(page_id) < extents_.size()) {
+      extent = extents_[page_id];
+    }
+  }
+  if (extent.length_ == 0) {
+    memset(page_data, 0, PAGE_SIZE);
+    return true;
+  }
+  if (extent.length_ == PAGE_SIZE) {
+    return ReadFully(db_fd_, page_data, PAGE_SIZE, static_cast<off_t>(extent.offset_));
+  }
+  thread_local char compressed[PAGE_SIZE];
+  if (!ReadFully(db_fd_, compressed, extent.length_, static_cast<off_t>(extent.offset_))) {
+    LOG_DEBUG("I/O error while reading");
+    return false;
+  }
+  if (!CompressionUtil::Decompress(compressed, extent.length_, page_data, PAGE_SIZE)) {
+    LOG_DEBUG("malformed compressed page %d", page_id);
+    return false;
+  }
+  return true;
+}
+
+page_id_t CompressedPageStore::GetNumPages() {
+  std::scoped_lock latch(latch_);
+  auto last =
+      std::find_if(extents_.rbegin(), extents_.rend(), [](const Extent &extent) { return extent.length_ != 0; });
+  return static_cast<page_id_t>(extents_.rend() - last);
+}
+
+uint64_t CompressedPageStore::GetStoredBytes() {
+  std::scoped_lock latch(latch_);
+  uint64_t stored_bytes = 0;
+  for (const auto &extent : extents_) {
+    stored_bytes += extent.length_;
+  }
+  return stored_bytes;
+}
+
+CompressedPageStore::Extent CompressedPageStore::Allocate(uint32_t capacity) {
+  auto iter = free_extents_.lower_bound(capacity);
+  if (iter == free_extents_.end()) {
+    Extent extent{end_offset_, 0, capacity};
+    end_offset_ += capacity;
+    return extent;
+  }
+  uint64_t offset = iter->second;
+  uint64_t free_capacity = iter->first;
+  RemoveFreeExtent(free_extents_by_offset_.find(offset));
+  if (free_capacity > capacity) {
+    AddFreeExtent(offset + capacity, free_capacity - capacity);
+  }
+  return Extent{offset, 0, capacity};
+}
+
+void CompressedPageStore::Free(const Extent &extent) {
+  uint64_t offset = extent.offset_;
+  uint64_t capacity = extent.capacity_;
+  auto next = free_extents_by_offset_.lower_bound(offset);
+  if (next != free_extents_by_offset_.begin()) {
+    auto prev = std::prev(next);
+    if (prev->first + prev->second == offset) {
+      offset = prev->first;
+      capacity += prev->second;
+      RemoveFreeExtent(prev);
+    }
+  }
+  if (next != free_extents_by_offset_.end() && next->first == offset + capacity) {
+    capacity += next->second;
+    RemoveFreeExtent(next);
+  }
+  if (offset + capacity == end_offset_) {
+    end_offset_ = offset;
+  } else {
+    AddFreeExtent(offset, capacity);
+  }
+}
+
+void CompressedPageStore::AddFreeExtent(uint64_t offset, uint64_t capacity) {
+  free_extents_.emplace(capacity, offset);
+  free_extents_by_offset_.emplace(offset, capacity);
+}
+
+void CompressedPageStore::RemoveFreeExtent(std::map<uint64_t, uint64_t>::iterator iter) {
+  auto [begin, end] = free_extents_.equal_range(iter->second);
+  free_extents_.erase(
+      std::find_if(begin, end, [&](const auto &free_extent) { return free_extent.second == iter->first; }));
+  free_extents_by_offset_.erase(iter);
+}
+
+bool CompressedPageStore::SetExtent(page_id_t page_id, const Extent &extent) {
+  if (static_cast<size_t>(page_id) >= extents_.size()) {
+    extents_.resize(page_id + 1, Extent{0, 0, 0});
+  }
+  extents_[page_id] = extent;
+  if (!WriteFully(map_fd_, reinterpret_cast<const char *>(&extent), sizeof(Extent),
+                  static_cast<off_t>(page_id) * sizeof(Extent))) {
+    LOG_DEBUG("I/O error while writing the extent map");
+    return false;
+  }
+  return true;
+}
+
+}  // namespace bustub
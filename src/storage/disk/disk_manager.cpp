@@ -10,34 +10,66 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <iterator>
+#include <memory>
 #include <mutex>  // NOLINT
 #include <string>
 #include <thread>  // NOLINT
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/util/checksum_util.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
 
 static char *buffer_used;
 
+/** Number of requests that can be in flight on the io_uring of a disk manager. */
+static constexpr unsigned IO_RING_ENTRIES = 256;
+
+/** Number of bytes the checksum file grows by at least, one page of the file. */
+static constexpr size_t CHECKSUM_FILE_GROWTH = 4096;
+
+/** @return true if buf can be used for O_DIRECT I/O as is */
+static bool IsAligned(const char *buf) { return reinterpret_cast<uintptr_t>(buf) % PAGE_SIZE == 0; }
+
+/** @return a page-aligned buffer of the calling thread, for O_DIRECT I/O on buffers that are not aligned */
+static char *BounceBuffer() {
+  thread_local std::unique_ptr<char[], decltype(&free)> buffer(static_cast<char *>(aligned_alloc(PAGE_SIZE, PAGE_SIZE)),
+                                                               &free);
+  return buffer.get();
+}
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr) {
+DiskManager::DiskManager(const std::string &db_file, DiskBackend backend, bool direct_io, bool checksums,
+                         bool compression)
+    : file_name_(db_file), num_flushes_(0), num_writes_(0), num_reads_(0), flush_log_(false), flush_log_f_(nullptr) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
     return;
   }
   log_name_ = file_name_.substr(0, n) + ".log";
+  fsm_name_ = file_name_.substr(0, n) + ".fsm";
+  checksum_name_ = file_name_.substr(0, n) + ".crc";
+  std::string extent_map_name = file_name_.substr(0, n) + ".cmap";
 
   log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
   // directory or file does not exist
@@ -53,30 +85,80 @@ DiskManager::DiskManager(const std::string &db_file)
     }
   }
 
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
+  // compressed pages are not aligned in the db file
+  direct_io = direct_io && !compression;
+  int flags = O_RDWR | (direct_io ? O_DIRECT : 0);
+  db_fd_ = open(db_file.c_str(), flags);
+  if (db_fd_ < 0 && errno == EINVAL && direct_io) {
+    // the file system does not support O_DIRECT
+    LOG_DEBUG("direct I/O is not available, the db file goes through the page cache");
+    flags &= ~O_DIRECT;
+    db_fd_ = open(db_file.c_str(), flags);
+  }
   // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
+  if (db_fd_ < 0) {
     // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
+    db_fd_ = open(db_file.c_str(), flags | O_CREAT | O_TRUNC, 0644);
+    if (db_fd_ < 0 && errno == EINVAL && direct_io) {
+      flags &= ~O_DIRECT;
+      db_fd_ = open(db_file.c_str(), flags | O_CREAT | O_TRUNC, 0644);
+    }
+    if (db_fd_ < 0) {
       throw Exception("can't open db file");
     }
+    // a free-page map or checksums left behind by an earlier database file of the same name do not apply to this one
+    std::remove(fsm_name_.c_str());
+    std::remove(checksum_name_.c_str());
+    std::remove(extent_map_name.c_str());
+  } else {
+    bool compressed = GetFileSize(extent_map_name) >= 0;
+    if (compressed != compression && (compressed || GetFileSize(file_name_) > 0)) {
+      close(db_fd_);
+      throw Exception(compressed ? "db file is compressed" : "db file is not compressed");
+    }
+    std::ifstream fsm_in(fsm_name_, std::ios::binary);
+    if (fsm_in.is_open()) {
+      free_page_map_.assign(std::istreambuf_iterator<char>(fsm_in), std::istreambuf_iterator<char>());
+    }
+    stale_checksum_file_ = !checksums && GetFileSize(checksum_name_) >= 0;
   }
+  if (checksums) {
+    checksum_fd_ = open(checksum_name_.c_str(), O_RDWR | O_CREAT, 0644);
+    if (checksum_fd_ < 0) {
+      throw Exception("can't open checksum file");
+    }
+    checksums_ = true;
+    GrowChecksumFile(GetFileSize(checksum_name_) / sizeof(ChecksumEntry));
+  }
+  direct_io_ = (flags & O_DIRECT) != 0;
   buffer_used = nullptr;
+  if (compression) {
+    compressed_store_ = new CompressedPageStore(db_fd_, extent_map_name);
+  }
+
+  if (backend == DiskBackend::IO_URING) {
+    ring_ = new IORing(IO_RING_ENTRIES);
+    if (!ring_->IsValid()) {
+      delete ring_;
+      ring_ = nullptr;
+    }
+  }
+}
+
+DiskManager::~DiskManager() {
+  FlushFreePageMap();
+  CloseDbFile();
 }
 
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
+  FlushFreePageMap();
+  CloseDbFile();
   {
-    std::scoped_lock scoped_db_io_latch(db_io_latch_);
-    db_io_.close();
+    std::scoped_lock scoped_fsm_latch(fsm_latch_);
+    fsm_io_.close();
   }
   log_io_.close();
 }
@@ -84,49 +166,513 @@ void DiskManager::ShutDown() {
 /**
  * Write the contents of the specified page into disk file
  */
-void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
-  // set write cursor to offset
+void DiskManager::WritePage(page_id_t page_id, const char *page_data) { WritePageData(page_id, page_data); }
+
+bool DiskManager::WritePageData(page_id_t page_id, const char *page_data) {
+  FlushFreePageMap();
+  off_t offset = static_cast<off_t>(page_id) * PAGE_SIZE;
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG_DEBUG("I/O error while writing");
-    return;
+  // A flush does not latch the page, so it may change while it is written. With checksums, the page is written from a
+  // copy, and the checksum is taken of that copy.
+  if (checksums_ || (direct_io_ && !IsAligned(page_data))) {
+    page_data = static_cast<const char *>(memcpy(BounceBuffer(), page_data, PAGE_SIZE));
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  uint32_t checksum = checksums_ ? ChecksumUtil::Crc32c(page_data, PAGE_SIZE) : 0;
+  if (compressed_store_ != nullptr) {
+    if (!compressed_store_->WritePage(page_id, page_data)) {
+      return false;
+    }
+    StoreChecksums(page_id, &checksum, 1);
+    return true;
+  }
+  // the write goes straight to the operating system, so there is nothing to flush
+  ssize_t written = 0;
+  while (written < PAGE_SIZE) {
+    ssize_t result = pwrite(db_fd_, page_data + written, PAGE_SIZE - written, offset + written);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    // check for I/O error
+    if (result <= 0) {
+      LOG_DEBUG("I/O error while writing");
+      return false;
+    }
+    written += result;
+  }
+  StoreChecksums(page_id, &checksum, 1);
+  return true;
+}
+
+/**
+ * Write a run of consecutive pages with vectored writes
+ */
+bool DiskManager::WritePages(page_id_t first_page_id, const std::vector<const char *> &pages) {
+  FlushFreePageMap();
+  size_t written_pages = 0;
+  // compressed pages are not adjacent in the db file, so they are written one by one below
+  bool vectored = compressed_store_ == nullptr;
+  // as in WritePageData, with checksums the pages are written from copies that the checksums are taken of
+  std::vector<const char *> run(pages);
+  std::vector<uint32_t> checksums(pages.size());
+  std::unique_ptr<char[], decltype(&free)> copies(nullptr, &free);
+  if (vectored && checksums_ && !pages.empty()) {
+    copies.reset(static_cast<char *>(aligned_alloc(PAGE_SIZE, pages.size() * PAGE_SIZE)));
+    for (size_t i = 0; i < pages.size(); ++i) {
+      run[i] = static_cast<const char *>(memcpy(copies.get() + i * PAGE_SIZE, pages[i], PAGE_SIZE));
+      checksums[i] = ChecksumUtil::Crc32c(run[i], PAGE_SIZE);
+    }
+  }
+  vectored = vectored && (!direct_io_ || std::all_of(run.begin(), run.end(), IsAligned));
+  while (vectored && written_pages < run.size()) {
+    std::vector<iovec> iov;
+    for (size_t i = written_pages; i < run.size() && iov.size() < IOV_MAX; ++i) {
+      iov.push_back({const_cast<char *>(run[i]), PAGE_SIZE});
+    }
+    off_t offset = static_cast<off_t>(first_page_id + written_pages) * PAGE_SIZE;
+    ssize_t result = pwritev(db_fd_, iov.data(), static_cast<int>(iov.size()), offset);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      break;
+    }
+    num_writes_ += result / PAGE_SIZE;
+    written_pages += result / PAGE_SIZE;
+    // a page that was written only partly is written again below
+    if (result % PAGE_SIZE != 0) {
+      break;
+    }
+  }
+  if (written_pages > 0) {
+    StoreChecksums(first_page_id, checksums.data(), written_pages);
+  }
+  bool success = true;
+  for (size_t i = written_pages; i < run.size(); ++i) {
+    success = WritePageData(first_page_id + static_cast<page_id_t>(i), run[i]) && success;
+  }
+  return success;
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * PAGE_SIZE;
-  // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
-    LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    if (db_io_.bad()) {
+  if (ReadPageData(page_id, page_data) && !VerifyChecksum(page_id, page_data)) {
+    throw PageCorruptionException(page_id);
+  }
+}
+
+bool DiskManager::ReadPageData(page_id_t page_id, char *page_data) {
+  off_t offset = static_cast<off_t>(page_id) * PAGE_SIZE;
+  num_reads_ += 1;
+  if (compressed_store_ != nullptr) {
+    return compressed_store_->ReadPage(page_id, page_data);
+  }
+  char *buffer = direct_io_ && !IsAligned(page_data) ? BounceBuffer() : page_data;
+  ssize_t read_count = 0;
+  while (read_count < PAGE_SIZE) {
+    ssize_t result = pread(db_fd_, buffer + read_count, PAGE_SIZE - read_count, offset + read_count);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result < 0) {
       LOG_DEBUG("I/O error while reading");
+      return false;
+    }
+    // the file ends before this page does
+    if (result == 0) {
+      break;
+    }
+    read_count += result;
+  }
+  if (read_count < PAGE_SIZE) {
+    LOG_DEBUG("Read less than a page");
+    memset(buffer + read_count, 0, PAGE_SIZE - read_count);
+  }
+  if (buffer != page_data) {
+    memcpy(page_data, buffer, PAGE_SIZE);
+  }
+  return true;
+}
+
+/**
+ * Read the contents of several pages, submitting them together so that they are read concurrently
+ */
+bool DiskManager::ReadPages(std::vector<std::pair<page_id_t, char *>> pages) {
+  std::sort(pages.begin(), pages.end());
+  std::vector<DiskRequest> requests(pages.size());
+  std::vector<DiskRequest *> submitted;
+  for (size_t i = 0; i < pages.size(); ++i) {
+    requests[i].page_id_ = pages[i].first;
+    requests[i].data_ = pages[i].second;
+    submitted.push_back(&requests[i]);
+  }
+  SubmitRequests(submitted);
+  bool success = true;
+  for (auto &request : requests) {
+    WaitForRequest(&request);
+    success = success && request.success_;
+  }
+  return success;
+}
+
+/**
+ * Submit requests to the ring, or carry them out right away if there is none
+ */
+void DiskManager::SubmitRequests(const std::vector<DiskRequest *> &requests) {
+  if (ring_ == nullptr || compressed_store_ != nullptr) {
+    for (DiskRequest *request : requests) {
+      DoRequest(request);
+    }
+    return;
+  }
+  // The page of a write may change while the write is in flight, see WritePageData. With checksums, the write
+  // goes out of a copy that lives as long as the request, which also serves O_DIRECT as it is aligned.
+  for (DiskRequest *request : requests) {
+    if (request->is_write_ && checksums_) {
+      request->stable_data_.reset(static_cast<char *>(aligned_alloc(PAGE_SIZE, PAGE_SIZE)));
+      memcpy(request->stable_data_.get(), request->data_, PAGE_SIZE);
+      request->checksum_ = ChecksumUtil::Crc32c(request->stable_data_.get(), PAGE_SIZE);
+    }
+  }
+  std::unique_lock ring_lock(ring_latch_);
+  for (DiskRequest *request : requests) {
+    char *data = request->stable_data_ != nullptr ? request->stable_data_.get() : request->data_;
+    // O_DIRECT needs an aligned buffer, and a bounce buffer would have to outlive the request
+    if (direct_io_ && !IsAligned(data)) {
+      DoRequest(request);
+      continue;
+    }
+    // keep the completion queue from overflowing
+    while (num_inflight_ >= ring_->GetEntries()) {
+      AwaitCompletions(&ring_lock);
+    }
+    off_t offset = static_cast<off_t>(request->page_id_) * PAGE_SIZE;
+    auto user_data = reinterpret_cast<uint64_t>(request);
+    if (request->is_write_) {
+      FlushFreePageMap();
+      num_writes_ += 1;
+      ring_->PrepareWrite(db_fd_, data, PAGE_SIZE, offset, user_data);
+    } else {
+      num_reads_ += 1;
+      ring_->PrepareRead(db_fd_, request->data_, PAGE_SIZE, offset, user_data);
+    }
+    ++num_inflight_;
+  }
+  if (ring_->Enter(0) < 0) {
+    LOG_DEBUG("can't submit to io_uring");
+  }
+}
+
+/**
+ * Reap completions until the request is done; whoever reaps a completion finishes its request, whichever thread
+ * waits for it
+ */
+void DiskManager::WaitForRequest(DiskRequest *request) {
+  if (request->done_.load(std::memory_order_acquire)) {
+    return;
+  }
+  std::unique_lock ring_lock(ring_latch_);
+  // without a ring, submitted requests are done before SubmitRequests returns
+  if (ring_ == nullptr) {
+    ring_lock.unlock();
+    DoRequest(request);
+    return;
+  }
+  while (!request->done_.load(std::memory_order_acquire)) {
+    // with nothing in flight and nobody reaping, every submitted request is done, so this one never was submitted
+    if (num_inflight_ == 0 && !ring_waiting_) {
+      ring_lock.unlock();
+      DoRequest(request);
+      return;
+    }
+    AwaitCompletions(&ring_lock);
+  }
+}
+
+void DiskManager::AwaitCompletions(std::unique_lock<std::mutex> *lock) {
+  if (ring_waiting_) {
+    ring_cv_.wait(*lock, [this] { return !ring_waiting_; });
+    return;
+  }
+  // what is already there may be all the caller is waiting for
+  if (ReapCompletions() > 0 || num_inflight_ == 0) {
+    return;
+  }
+  if (ring_->Enter(0) < 0) {
+    LOG_DEBUG("can't submit to io_uring");
+  }
+  ring_waiting_ = true;
+  lock->unlock();
+  ring_->Wait(1);
+  lock->lock();
+  ring_waiting_ = false;
+  ReapCompletions();
+  ring_cv_.notify_all();
+}
+
+void DiskManager::DoRequest(DiskRequest *request) {
+  request->success_ =
+      request->is_write_
+          ? WritePageData(request->page_id_, request->data_)
+          : ReadPageData(request->page_id_, request->data_) && VerifyChecksum(request->page_id_, request->data_);
+  request->done_.store(true, std::memory_order_release);
+}
+
+size_t DiskManager::ReapCompletions() {
+  uint64_t user_data;
+  int result;
+  size_t num_reaped = 0;
+  while (ring_->PopCompletion(&user_data, &result)) {
+    --num_inflight_;
+    ++num_reaped;
+    FinishRequest(reinterpret_cast<DiskRequest *>(user_data), result);
+  }
+  return num_reaped;
+}
+
+void DiskManager::FinishRequest(DiskRequest *request, ssize_t result) {
+  if (result < 0 && request->is_write_) {
+    LOG_DEBUG("I/O error while writing");
+  } else if (result < 0) {
+    LOG_DEBUG("I/O error while reading");
+  } else if (!request->is_write_ && result < PAGE_SIZE) {
+    // the file ends before this page does
+    memset(request->data_ + result, 0, PAGE_SIZE - result);
+  }
+  if (request->is_write_) {
+    request->success_ = result == PAGE_SIZE;
+    if (request->success_) {
+      StoreChecksums(request->page_id_, &request->checksum_, 1);
+    }
+    request->stable_data_.reset();
+  } else {
+    request->success_ = result >= 0 && VerifyChecksum(request->page_id_, request->data_);
+  }
+  request->done_.store(true, std::memory_order_release);
+}
+
+void DiskManager::StoreChecksums(page_id_t first_page_id, const uint32_t *checksums, size_t num_pages) {
+  if (!checksums_) {
+    // the checksums of the pages being overwritten no longer hold
+    if (stale_checksum_file_.exchange(false)) {
+      std::remove(checksum_name_.c_str());
+    }
+    return;
+  }
+  size_t end = static_cast<size_t>(first_page_id) + num_pages;
+  std::shared_lock checksum_latch(checksum_latch_);
+  while (end > checksum_capacity_) {
+    checksum_latch.unlock();
+    GrowChecksumFile(end);
+    checksum_latch.lock();
+  }
+  for (size_t i = 0; i < num_pages; ++i) {
+    checksum_map_[first_page_id + i] = {checksums[i], 1};
+  }
+}
+
+bool DiskManager::VerifyChecksum(page_id_t page_id, const char *page_data) {
+  if (!checksums_) {
+    return true;
+  }
+  ChecksumEntry entry{0, 0};
+  {
+    std::shared_lock checksum_latch(checksum_latch_);
+    if (static_cast<size_t>(page_id) < checksum_capacity_) {
+      entry = checksum_map_[page_id];
+    }
+  }
+  // pages never written with checksums on have none
+  if (entry.is_set_ == 0 || entry.checksum_ == ChecksumUtil::Crc32c(page_data, PAGE_SIZE)) {
+    return true;
+  }
+  LOG_DEBUG("checksum mismatch on page %d", page_id);
+  num_checksum_failures_ += 1;
+  return false;
+}
+
+void DiskManager::GrowChecksumFile(size_t num_pages) {
+  std::unique_lock checksum_latch(checksum_latch_);
+  if (num_pages <= checksum_capacity_ && checksum_map_ != nullptr) {
+    return;
+  }
+  const size_t growth = CHECKSUM_FILE_GROWTH / sizeof(ChecksumEntry);
+  size_t capacity = std::max({num_pages, checksum_capacity_ * 2, growth});
+  capacity = (capacity + growth - 1) / growth * growth;
+  if (ftruncate(checksum_fd_, static_cast<off_t>(capacity * sizeof(ChecksumEntry))) != 0) {
+    throw Exception("can't grow checksum file");
+  }
+  void *map = mmap(nullptr, capacity * sizeof(ChecksumEntry), PROT_READ | PROT_WRITE, MAP_SHARED, checksum_fd_, 0);
+  if (map == MAP_FAILED) {
+    throw Exception("can't map checksum file");
+  }
+  if (checksum_map_ != nullptr) {
+    munmap(checksum_map_, checksum_capacity_ * sizeof(ChecksumEntry));
+  }
+  checksum_map_ = static_cast<ChecksumEntry *>(map);
+  checksum_capacity_ = capacity;
+}
+
+char *DiskManager::MapFile(page_id_t *num_pages) {
+  std::scoped_lock scoped_mapping_latch(mapping_latch_);
+  if (mapping_ == nullptr) {
+    if (db_fd_ < 0 || compressed_store_ != nullptr) {
+      *num_pages = 0;
+      return nullptr;
+    }
+    // Touching a page of the mapping that lies wholly beyond the end of the file raises SIGBUS, which a partial last
+    // page can reach when PAGE_SIZE spans several memory pages, so only whole pages are mapped.
+    int file_size = GetFileSize(file_name_);
+    page_id_t file_pages = file_size <= 0 ? 0 : file_size / PAGE_SIZE;
+    if (file_pages == 0) {
+      *num_pages = 0;
+      return nullptr;
+    }
+    void *mapping = mmap(nullptr, static_cast<size_t>(file_pages) * PAGE_SIZE, PROT_READ, MAP_SHARED, db_fd_, 0);
+    if (mapping == MAP_FAILED) {
+      LOG_DEBUG("can't map db file");
+      *num_pages = 0;
+      return nullptr;
+    }
+    mapping_ = static_cast<char *>(mapping);
+    mapped_pages_ = file_pages;
+  }
+  *num_pages = mapped_pages_;
+  return mapping_;
+}
+
+void DiskManager::CloseDbFile() {
+  if (ring_ != nullptr) {
+    std::unique_lock ring_lock(ring_latch_);
+    // requests still in flight would otherwise complete into buffers that may be gone by now
+    while (num_inflight_ > 0 || ring_waiting_) {
+      AwaitCompletions(&ring_lock);
+    }
+    delete ring_;
+    ring_ = nullptr;
+  }
+  {
+    std::scoped_lock scoped_mapping_latch(mapping_latch_);
+    if (mapping_ != nullptr) {
+      munmap(mapping_, static_cast<size_t>(mapped_pages_) * PAGE_SIZE);
+      mapping_ = nullptr;
+    }
+  }
+  delete compressed_store_;
+  compressed_store_ = nullptr;
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+    db_fd_ = -1;
+  }
+  if (checksum_fd_ >= 0) {
+    std::scoped_lock checksum_latch(checksum_latch_);
+    munmap(checksum_map_, checksum_capacity_ * sizeof(ChecksumEntry));
+    checksum_map_ = nullptr;
+    checksum_capacity_ = 0;
+    close(checksum_fd_);
+    checksum_fd_ = -1;
+  }
+}
+
+/**
+ * Returns the number of pages the database file spans, counting a partial last page
+ */
+page_id_t DiskManager::GetNumPages() {
+  if (compressed_store_ != nullptr) {
+    return compressed_store_->GetNumPages();
+  }
+  int file_size = GetFileSize(file_name_);
+  return file_size <= 0 ? 0 : (file_size + PAGE_SIZE - 1) / PAGE_SIZE;
+}
+
+/**
+ * Returns the number of bytes taken up by pages
+ */
+uint64_t DiskManager::GetStoredBytes() {
+  if (compressed_store_ != nullptr) {
+    return compressed_store_->GetStoredBytes();
+  }
+  return static_cast<uint64_t>(GetNumPages()) * PAGE_SIZE;
+}
+
+/**
+ * Mark a page as free in the free-page map
+ */
+void DiskManager::DeallocatePage(page_id_t page_id) { SetPageFree(page_id, true); }
+
+/**
+ * Mark a page as in use again in the free-page map
+ */
+void DiskManager::ReusePage(page_id_t page_id) { SetPageFree(page_id, false); }
+
+/**
+ * Returns the ids of all free pages in ascending order
+ */
+std::vector<page_id_t> DiskManager::GetFreePages() {
+  std::scoped_lock scoped_fsm_latch(fsm_latch_);
+  std::vector<page_id_t> free_pages;
+  for (size_t byte = 0; byte < free_page_map_.size(); ++byte) {
+    for (size_t bit = 0; bit < 8; ++bit) {
+      if ((free_page_map_[byte] & (1U << bit)) != 0) {
+        free_pages.push_back(static_cast<page_id_t>(byte * 8 + bit));
+      }
+    }
+  }
+  return free_pages;
+}
+
+void DiskManager::SetPageFree(page_id_t page_id, bool is_free) {
+  std::scoped_lock scoped_fsm_latch(fsm_latch_);
+  size_t byte = static_cast<size_t>(page_id) / 8;
+  if (byte >= free_page_map_.size()) {
+    if (!is_free) {
       return;
     }
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+    free_page_map_.resize(byte + 1, 0);
+  }
+  if (is_free) {
+    free_page_map_[byte] |= 1U << (page_id % 8);
+  } else {
+    free_page_map_[byte] &= ~(1U << (page_id % 8));
+  }
+  if (!fsm_dirty_.load(std::memory_order_relaxed)) {
+    fsm_dirty_begin_ = byte;
+    fsm_dirty_end_ = byte + 1;
+  } else {
+    fsm_dirty_begin_ = std::min(fsm_dirty_begin_, byte);
+    fsm_dirty_end_ = std::max(fsm_dirty_end_, byte + 1);
+  }
+  fsm_dirty_.store(true, std::memory_order_release);
+}
+
+void DiskManager::FlushFreePageMap() {
+  // page writes call this all the time, so the common case of no changes takes no latch
+  if (!fsm_dirty_.load(std::memory_order_acquire)) {
+    return;
+  }
+  std::scoped_lock scoped_fsm_latch(fsm_latch_);
+  if (!fsm_dirty_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  if (!fsm_io_.is_open()) {
+    // create the file if this is the first page ever freed, without truncating an existing one
+    fsm_io_.open(fsm_name_, std::ios::binary | std::ios::out | std::ios::app);
+    fsm_io_.close();
+    fsm_io_.open(fsm_name_, std::ios::binary | std::ios::in | std::ios::out);
+    if (!fsm_io_.is_open()) {
+      LOG_DEBUG("can't open free-page map file");
+      return;
     }
   }
+  fsm_io_.seekp(fsm_dirty_begin_);
+  fsm_io_.write(reinterpret_cast<const char *>(&free_page_map_[fsm_dirty_begin_]), fsm_dirty_end_ - fsm_dirty_begin_);
+  fsm_io_.flush();
+  if (fsm_io_.bad()) {
+    LOG_DEBUG("I/O error while writing free-page map");
+    return;
+  }
+  fsm_dirty_.store(false, std::memory_order_relaxed);
 }
 
 /**
@@ -201,6 +747,11 @@ int DiskManager::GetNumFlushes() const { return num_flushes_; }
  */
 int DiskManager::GetNumWrites() const { return num_writes_; }
 
+/**
+ * Returns number of Reads made so far
+ */
+int DiskManager::GetNumReads() const { return num_reads_; }
+
 /**
  * Returns true if the log is currently being flushed
  */
@@ -0,0 +1,146 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.cpp
+//
+// Identification: src/storage/disk/disk_scheduler.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_scheduler.h"
+
+#include <memory>
+#include <utility>
+
+namespace bustub {
+
+DiskScheduler::DiskScheduler(DiskManager *disk_manager, size_t num_workers) : disk_manager_(disk_manager) {
+  for (size_t i = 0; i < num_workers; ++i) {
+    workers_.emplace_back(&DiskScheduler::WorkerLoop, this);
+  }
+}
+
+DiskScheduler::~DiskScheduler() {
+  {
+    std::scoped_lock latch(latch_);
+    stop_ = true;
+    cv_.notify_all();
+  }
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void DiskScheduler::ScheduleRead(page_id_t page_id, char *data, Callback callback) {
+  Enqueue(page_id, Request{false, data, std::move(callback)});
+}
+
+void DiskScheduler::ScheduleWrite(page_id_t page_id, const char *data, Callback callback) {
+  Enqueue(page_id, Request{true, const_cast<char *>(data), std::move(callback)});
+}
+
+std::future<bool> DiskScheduler::ScheduleRead(page_id_t page_id, char *data) {
+  auto promise = std::make_shared<std::promise<bool>>();
+  auto future = promise->get_future();
+  ScheduleRead(page_id, data, [promise](bool success) { promise->set_value(success); });
+  return future;
+}
+
+std::future<bool> DiskScheduler::ScheduleWrite(page_id_t page_id, const char *data) {
+  auto promise = std::make_shared<std::promise<bool>>();
+  auto future = promise->get_future();
+  ScheduleWrite(page_id, data, [promise](bool success) { promise->set_value(success); });
+  return future;
+}
+
+std::vector<std::future<bool>> DiskScheduler::ScheduleWrites(
+    const std::vector<std::pair<page_id_t, const char *>> &pages) {
+  std::vector<std::future<bool>> futures;
+  std::scoped_lock latch(latch_);
+  for (const auto &[page_id, data] : pages) {
+    auto promise = std::make_shared<std::promise<bool>>();
+    futures.push_back(promise->get_future());
+    queue_.emplace(page_id,
+                   Request{true, const_cast<char *>(data), [promise](bool success) { promise->set_value(success); }});
+  }
+  cv_.notify_all();
+  return futures;
+}
+
+void DiskScheduler::Enqueue(page_id_t page_id, Request request) {
+  std::scoped_lock latch(latch_);
+  queue_.emplace(page_id, std::move(request));
+  cv_.notify_one();
+}
+
+void DiskScheduler::WorkerLoop() {
+  std::unique_lock latch(latch_);
+  std::vector<std::pair<page_id_t, Request>> batch;
+  while (true) {
+    cv_.wait(latch, [&] { return stop_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      return;
+    }
+    // Take the requests from next_page_id_ on, wrapping around to the start of the file at the end.
+    auto iter = queue_.lower_bound(next_page_id_);
+    if (iter == queue_.end()) {
+      iter = queue_.begin();
+    }
+    while (iter != queue_.end() && batch.size() < BATCH_SIZE) {
+      batch.emplace_back(iter->first, std::move(iter->second));
+      iter = queue_.erase(iter);
+    }
+    next_page_id_ = batch.back().first + 1;
+    latch.unlock();
+    RunBatch(&batch);
+    batch.clear();
+    latch.lock();
+  }
+}
+
+void DiskScheduler::RunBatch(std::vector<std::pair<page_id_t, Request>> *batch) {
+  // Carry the batch out in groups: runs of writes to consecutive pages, and reads, which are submitted together.
+  size_t group_begin = 0;
+  while (group_begin < batch->size()) {
+    bool is_write = (*batch)[group_begin].second.is_write_;
+    size_t group_end = group_begin + 1;
+    while (group_end < batch->size() && (*batch)[group_end].second.is_write_ == is_write &&
+           (!is_write || (*batch)[group_end].first == (*batch)[group_end - 1].first + 1)) {
+      ++group_end;
+    }
+    if (is_write) {
+      std::vector<const char *> pages;
+      for (size_t i = group_begin; i < group_end; ++i) {
+        pages.push_back((*batch)[i].second.data_);
+      }
+      bool success = disk_manager_->WritePages((*batch)[group_begin].first, pages);
+      if (pages.size() > 1) {
+        ++num_merged_writes_;
+      }
+      // An error is reported to the whole run, because the vectored write does not tell which page failed.
+      for (size_t i = group_begin; i < group_end; ++i) {
+        (*batch)[i].second.callback_(success);
+      }
+    } else {
+      // Each read reports its own result, so a page that fails its checksum does not fail the others.
+      std::vector<DiskRequest> requests(group_end - group_begin);
+      std::vector<DiskRequest *> submitted;
+      for (size_t i = group_begin; i < group_end; ++i) {
+        requests[i - group_begin].page_id_ = (*batch)[i].first;
+        requests[i - group_begin].data_ = (*batch)[i].second.data_;
+        submitted.push_back(&requests[i - group_begin]);
+      }
+      disk_manager_->SubmitRequests(submitted);
+      for (size_t i = group_begin; i < group_end; ++i) {
+        disk_manager_->WaitForRequest(&requests[i - group_begin]);
+        (*batch)[i].second.callback_(requests[i - group_begin].success_);
+      }
+    }
+    group_begin = group_end;
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,185 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_ring.cpp
+//
+// Identification: src/storage/disk/io_ring.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/io_ring.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef BUSTUB_HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#endif
+
+#include "common/logger.h"
+
+namespace bustub {
+
+#ifdef BUSTUB_HAVE_IO_URING
+
+IORing::IORing(unsigned entries) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+  if (ring_fd < 0) {
+    LOG_DEBUG("io_uring is not available");
+    return;
+  }
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  // Newer kernels map both rings with a single mapping.
+  bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  sq_ring_ =
+      mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+  cq_ring_ = single_mmap ? sq_ring_
+                         : mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                                IORING_OFF_CQ_RING);
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+  if (sq_ring_ == MAP_FAILED || cq_ring_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+    LOG_DEBUG("can't map the io_uring queues");
+    if (sq_ring_ != MAP_FAILED) {
+      munmap(sq_ring_, sq_ring_size_);
+    }
+    if (!single_mmap && cq_ring_ != MAP_FAILED) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sqes_ != MAP_FAILED) {
+      munmap(sqes_, sqes_size_);
+    }
+    close(ring_fd);
+    return;
+  }
+
+  auto *sq_ring = static_cast<char *>(sq_ring_);
+  auto *cq_ring = static_cast<char *>(cq_ring_);
+  sq_head_ = reinterpret_cast<unsigned *>(sq_ring + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq_ring + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned *>(sq_ring + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq_ring + params.sq_off.array);
+  cq_head_ = reinterpret_cast<unsigned *>(cq_ring + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq_ring + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned *>(cq_ring + params.cq_off.ring_mask);
+  cqes_ = cq_ring + params.cq_off.cqes;
+  sq_entries_ = params.sq_entries;
+  ring_fd_ = ring_fd;
+}
+
+IORing::~IORing() {
+  if (ring_fd_ < 0) {
+    return;
+  }
+  munmap(sqes_, sqes_size_);
+  if (cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  munmap(sq_ring_, sq_ring_size_);
+  close(ring_fd_);
+}
+
+bool IORing::Prepare(uint8_t opcode, int fd, uint64_t addr, size_t len, off_t offset, uint64_t user_data) {
+  // Only we move the tail, the kernel moves the head as it consumes entries.
+  unsigned tail = *sq_tail_;
+  if (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_) {
+    return false;
+  }
+  unsigned index = tail & *sq_mask_;
+  auto *sqe = static_cast<io_uring_sqe *>(sqes_) + index;
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->addr = addr;
+  sqe->len = static_cast<uint32_t>(len);
+  sqe->off = static_cast<uint64_t>(offset);
+  sqe->user_data = user_data;
+  sq_array_[index] = index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  ++to_submit_;
+  return true;
+}
+
+bool IORing::PrepareRead(int fd, char *buf, size_t len, off_t offset, uint64_t user_data) {
+  return Prepare(IORING_OP_READ, fd, reinterpret_cast<uint64_t>(buf), len, offset, user_data);
+}
+
+bool IORing::PrepareWrite(int fd, const char *buf, size_t len, off_t offset, uint64_t user_data) {
+  return Prepare(IORING_OP_WRITE, fd, reinterpret_cast<uint64_t>(buf), len, offset, user_data);
+}
+
+int IORing::Enter(unsigned min_complete) {
+  unsigned flags = min_complete > 0 ? IORING_ENTER_GETEVENTS : 0;
+  while (true) {
+    auto submitted =
+        static_cast<int>(syscall(__NR_io_uring_enter, ring_fd_, to_submit_, min_complete, flags, nullptr, 0));
+    if (submitted >= 0) {
+      to_submit_ -= static_cast<unsigned>(submitted);
+      return submitted;
+    }
+    if (errno != EINTR) {
+      return -errno;
+    }
+  }
+}
+
+int IORing::Wait(unsigned min_complete) {
+  while (syscall(__NR_io_uring_enter, ring_fd_, 0, min_complete, IORING_ENTER_GETEVENTS, nullptr, 0) < 0) {
+    if (errno != EINTR) {
+      return -errno;
+    }
+  }
+  return 0;
+}
+
+bool IORing::PopCompletion(uint64_t *user_data, int *result) {
+  // Only we move the head, the kernel moves the tail as requests complete.
+  unsigned head = *cq_head_;
+  if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+    return false;
+  }
+  const auto *cqe = static_cast<io_uring_cqe *>(cqes_) + (head & *cq_mask_);
+  *user_data = cqe->user_data;
+  *result = cqe->res;
+  __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+#else
+
+IORing::IORing(unsigned entries) {}
+
+IORing::~IORing() = default;
+
+bool IORing::Prepare(uint8_t opcode, int fd, uint64_t addr, size_t len, off_t offset, uint64_t user_data) {
+  return false;
+}
+
+bool IORing::PrepareRead(int fd, char *buf, size_t len, off_t offset, uint64_t user_data) { return false; }
+
+bool IORing::PrepareWrite(int fd, const char *buf, size_t len, off_t offset, uint64_t user_data) { return false; }
+
+int IORing::Enter(unsigned min_complete) { return -ENOSYS; }
+
+int IORing::Wait(unsigned min_complete) { return -ENOSYS; }
+
+bool IORing::PopCompletion(uint64_t *user_data, int *result) { return false; }
+
+#endif
+
+}  // namespace bustub
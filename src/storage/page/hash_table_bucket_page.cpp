@@ -11,6 +11,13 @@
 //===----------------------------------------------------------------------===//
 
 #include "storage/page/hash_table_bucket_page.h"
+
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
 #include "common/logger.h"
 #include "common/util/hash_util.h"
 #include "storage/index/generic_key.h"
@@ -19,49 +26,106 @@
 
 namespace bustub {
 
+/** Number of slots whose fingerprints are compared at a time. */
+static constexpr uint32_t FINGERPRINT_GROUP_SIZE = 32;
+
+/**
+ * @return a mask with bit i set if fingerprints[i] equals fingerprint, for the FINGERPRINT_GROUP_SIZE fingerprints from
+ * fingerprints on
+ */
+static inline uint32_t MatchFingerprints(const uint8_t *fingerprints, uint8_t fingerprint) {
+#if defined(__AVX2__)
+  __m256i group = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(fingerprints));
+  __m256i matches = _mm256_cmpeq_epi8(group, _mm256_set1_epi8(static_cast<char>(fingerprint)));
+  return static_cast<uint32_t>(_mm256_movemask_epi8(matches));
+#elif defined(__SSE2__)
+  __m128i needle = _mm_set1_epi8(static_cast<char>(fingerprint));
+  __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(fingerprints));
+  __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(fingerprints + 16));
+  auto low_matches = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(low, needle)));
+  auto high_matches = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(high, needle)));
+  return low_matches | (high_matches << 16);
+#else
+  uint32_t matches = 0;
+  for (uint32_t i = 0; i < FINGERPRINT_GROUP_SIZE; ++i) {
+    matches |= static_cast<uint32_t>(fingerprints[i] == fingerprint) << i;
+  }
+  return matches;
+#endif
+}
+
 template <typename KeyType, typename ValueType, typename KeyComparator>
-bool HASH_TABLE_BUCKET_TYPE::GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) {
+template <typename Visitor>
+bool HASH_TABLE_BUCKET_TYPE::ForEachCandidate(uint8_t fingerprint, Visitor visit) const {
+  uint32_t group_begin = 0;
+  for (; group_begin + FINGERPRINT_GROUP_SIZE <= BUCKET_ARRAY_SIZE; group_begin += FINGERPRINT_GROUP_SIZE) {
+    // The group starts on a byte of readable_, whose bits are the readable flags of the group's slots in order.
+    uint32_t readable = 0;
+    for (uint32_t i = 0; i < FINGERPRINT_GROUP_SIZE / 8; ++i) {
+      readable |= static_cast<uint32_t>(static_cast<uint8_t>(readable_[group_begin / 8 + i])) << (8 * i);
+    }
+    uint32_t candidates = MatchFingerprints(fingerprints_ + group_begin, fingerprint) & readable;
+    while (candidates != 0) {
+      if (visit(group_begin + __builtin_ctz(candidates))) {
+        return true;
+      }
+      candidates &= candidates - 1;
+    }
+  }
+  for (uint32_t i = group_begin; i < BUCKET_ARRAY_SIZE; ++i) {
+    if (fingerprints_[i] == fingerprint && IsReadable(i) && visit(i)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result,
+                                      uint8_t fingerprint) {
   bool is_matched = false;
-  for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE; ++i) {
-    if (IsReadable(i) && !cmp(key, KeyAt(i))) {
+  ForEachCandidate(fingerprint, [&](uint32_t i) {
+    if (!cmp(key, KeyAt(i))) {
       result->emplace_back(ValueAt(i));
       is_matched = true;
     }
-  }
+    return false;
+  });
   return is_matched;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-bool HASH_TABLE_BUCKET_TYPE::Insert(KeyType key, ValueType value, KeyComparator cmp) {
+bool HASH_TABLE_BUCKET_TYPE::Insert(KeyType key, ValueType value, KeyComparator cmp, uint8_t fingerprint) {
   if (IsFull()) {
     return false;
   }
-  bool find_index = false;
-  uint32_t insert_index;
-  for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE; ++i) {
-    if (!IsReadable(i) && !find_index) {
-      find_index = true;
-      insert_index = i;
-    }
-    if (IsReadable(i) && cmp(key, KeyAt(i)) == 0 && value == ValueAt(i)) {
-      return false;
-    }
+  if (ForEachCandidate(fingerprint, [&](uint32_t i) { return cmp(key, KeyAt(i)) == 0 && value == ValueAt(i); })) {
+    return false;
+  }
+  // Take the first slot that is not readable, skipping eight readable slots at a time.
+  uint32_t insert_index = 0;
+  while (static_cast<uint8_t>(readable_[insert_index / 8]) == 0xff) {
+    insert_index += 8;
+  }
+  while (IsReadable(insert_index)) {
+    ++insert_index;
   }
   array_[insert_index] = std::make_pair(key, value);
+  fingerprints_[insert_index] = fingerprint;
   SetOccupied(insert_index);
   SetReadable(insert_index);
   return true;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-bool HASH_TABLE_BUCKET_TYPE::Remove(KeyType key, ValueType value, KeyComparator cmp) {
-  for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE; ++i) {
-    if (IsReadable(i) && !cmp(key, KeyAt(i)) && (ValueAt(i) == value)) {
+bool HASH_TABLE_BUCKET_TYPE::Remove(KeyType key, ValueType value, KeyComparator cmp, uint8_t fingerprint) {
+  return ForEachCandidate(fingerprint, [&](uint32_t i) {
+    if (!cmp(key, KeyAt(i)) && (ValueAt(i) == value)) {
       RemoveAt(i);
       return true;
     }
-  }
-  return false;
+    return false;
+  });
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
@@ -74,6 +138,11 @@ ValueType HASH_TABLE_BUCKET_TYPE::ValueAt(uint32_t bucket_idx) const {
   return array_[bucket_idx].second;
 }
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint8_t HASH_TABLE_BUCKET_TYPE::FingerprintAt(uint32_t bucket_idx) const {
+  return fingerprints_[bucket_idx];
+}
+
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_BUCKET_TYPE::RemoveAt(uint32_t bucket_idx) {
   if (IsReadable(bucket_idx)) {
@@ -16,7 +16,18 @@
 #include "common/logger.h"
 
 namespace bustub {
-void HashTableDirectoryPage::Init() { global_depth_ = 0; }
+void HashTableDirectoryPage::Init() {
+  global_depth_ = 0;
+  std::fill(segment_page_ids_, segment_page_ids_ + DIRECTORY_MAX_PAGES, INVALID_PAGE_ID);
+}
+
+page_id_t HashTableDirectoryPage::GetSegmentPageId(uint32_t segment_idx) {
+  return __atomic_load_n(&segment_page_ids_[segment_idx], __ATOMIC_RELAXED);
+}
+
+void HashTableDirectoryPage::SetSegmentPageId(uint32_t segment_idx, page_id_t segment_page_id) {
+  __atomic_store_n(&segment_page_ids_[segment_idx], segment_page_id, __ATOMIC_RELAXED);
+}
 
 page_id_t HashTableDirectoryPage::GetPageId() const { return page_id_; }
 
@@ -26,22 +37,28 @@ lsn_t HashTableDirectoryPage::GetLSN() const { return lsn_; }
 
 void HashTableDirectoryPage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
 
-uint32_t HashTableDirectoryPage::GetGlobalDepth() { return global_depth_; }
+uint32_t HashTableDirectoryPage::GetGlobalDepth() { return __atomic_load_n(&global_depth_, __ATOMIC_RELAXED); }
 
-uint32_t HashTableDirectoryPage::GetGlobalDepthMask() { return (1U << global_depth_) - 1; }
+uint32_t HashTableDirectoryPage::GetGlobalDepthMask() { return (1U << GetGlobalDepth()) - 1; }
 
 uint32_t HashTableDirectoryPage::GetLocalDepthMask(uint32_t bucket_idx) {
-  return (1U << local_depths_[bucket_idx]) - 1;
+  return (1U << GetLocalDepth(bucket_idx)) - 1;
 }
 
-void HashTableDirectoryPage::IncrGlobalDepth() { ++global_depth_; }
+void HashTableDirectoryPage::IncrGlobalDepth() {
+  __atomic_store_n(&global_depth_, global_depth_ + 1, __ATOMIC_RELAXED);
+}
 
-void HashTableDirectoryPage::DecrGlobalDepth() { --global_depth_; }
+void HashTableDirectoryPage::DecrGlobalDepth() {
+  __atomic_store_n(&global_depth_, global_depth_ - 1, __ATOMIC_RELAXED);
+}
 
-page_id_t HashTableDirectoryPage::GetBucketPageId(uint32_t bucket_idx) { return bucket_page_ids_[bucket_idx]; }
+page_id_t HashTableDirectoryPage::GetBucketPageId(uint32_t bucket_idx) {
+  return __atomic_load_n(&bucket_page_ids_[bucket_idx], __ATOMIC_RELAXED);
+}
 
 void HashTableDirectoryPage::SetBucketPageId(uint32_t bucket_idx, page_id_t bucket_page_id) {
-  bucket_page_ids_[bucket_idx] = bucket_page_id;
+  __atomic_store_n(&bucket_page_ids_[bucket_idx], bucket_page_id, __ATOMIC_RELAXED);
 }
 
 uint32_t HashTableDirectoryPage::GetSplitImageIndex(uint32_t bucket_idx) {
@@ -49,10 +66,10 @@ uint32_t HashTableDirectoryPage::GetSplitImageIndex(uint32_t bucket_idx) {
 }
 
 uint32_t HashTableDirectoryPage::GetMergeImageIndex(uint32_t bucket_idx) {
-  return bucket_idx ^ (1U << (local_depths_[bucket_idx] - 1));
+  return bucket_idx ^ (1U << (GetLocalDepth(bucket_idx) - 1));
 }
 
-uint32_t HashTableDirectoryPage::Size() { return 1U << global_depth_; }
+uint32_t HashTableDirectoryPage::Size() { return 1U << GetGlobalDepth(); }
 
 bool HashTableDirectoryPage::CanShrink() {
   bool can_shrink = true;
@@ -64,17 +81,23 @@ bool HashTableDirectoryPage::CanShrink() {
   return can_shrink;
 }
 
-uint32_t HashTableDirectoryPage::GetLocalDepth(uint32_t bucket_idx) { return local_depths_[bucket_idx]; }
+uint32_t HashTableDirectoryPage::GetLocalDepth(uint32_t bucket_idx) {
+  return __atomic_load_n(&local_depths_[bucket_idx], __ATOMIC_RELAXED);
+}
 
 void HashTableDirectoryPage::SetLocalDepth(uint32_t bucket_idx, uint8_t local_depth) {
-  local_depths_[bucket_idx] = local_depth;
+  __atomic_store_n(&local_depths_[bucket_idx], local_depth, __ATOMIC_RELAXED);
 }
 
-void HashTableDirectoryPage::IncrLocalDepth(uint32_t bucket_idx) { ++local_depths_[bucket_idx]; }
+void HashTableDirectoryPage::IncrLocalDepth(uint32_t bucket_idx) {
+  SetLocalDepth(bucket_idx, local_depths_[bucket_idx] + 1);
+}
 
-void HashTableDirectoryPage::DecrLocalDepth(uint32_t bucket_idx) { --local_depths_[bucket_idx]; }
+void HashTableDirectoryPage::DecrLocalDepth(uint32_t bucket_idx) {
+  SetLocalDepth(bucket_idx, local_depths_[bucket_idx] - 1);
+}
 
-uint32_t HashTableDirectoryPage::GetLocalHighBit(uint32_t bucket_idx) { return 1U << local_depths_[bucket_idx]; }
+uint32_t HashTableDirectoryPage::GetLocalHighBit(uint32_t bucket_idx) { return 1U << GetLocalDepth(bucket_idx); }
 
 /**
  * VerifyIntegrity - Use this for debugging but **DO NOT CHANGE**
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
 
 #include "storage/table/table_heap.h"
@@ -43,6 +44,7 @@ TableIterator &TableIterator::operator++() {
   if (!cur_page->GetNextTupleRid(tuple_->rid_,
                                  &next_tuple_rid)) {  // end of this page
     while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
+      ReadAhead(cur_page->GetTablePageId(), cur_page->GetNextPageId());
       auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
       cur_page->RUnlatch();
       buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
@@ -64,6 +66,20 @@ TableIterator &TableIterator::operator++() {
   return *this;
 }
 
+void TableIterator::ReadAhead(page_id_t prev_page_id, page_id_t page_id) {
+  if (page_id != prev_page_id + 1) {
+    readahead_end_ = INVALID_PAGE_ID;
+    return;
+  }
+  // Refill the window once the scan has consumed half of it, so that the reads stay ahead of the scan.
+  if (page_id + READAHEAD_PAGES / 2 < readahead_end_) {
+    return;
+  }
+  page_id_t readahead_begin = std::max(readahead_end_, page_id + 1);
+  readahead_end_ = page_id + 1 + READAHEAD_PAGES;
+  table_heap_->buffer_pool_manager_->Prefetch(readahead_begin, readahead_end_ - readahead_begin);
+}
+
 TableIterator TableIterator::operator++(int) {
   TableIterator clone(*this);
   ++(*this);
@@ -0,0 +1,439 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_benchmark_test.cpp
+//
+// Identification: test/buffer/buffer_pool_manager_benchmark_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "catalog/catalog.h"
+#include "common/util/checksum_util.h"
+#include "concurrency/transaction_manager.h"
+#include "container/hash/extendible_hash_table.h"
+#include "execution/execution_engine.h"
+#include "execution/executor_context.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "gtest/gtest.h"
+#include "storage/index/int_comparator.h"
+#include "type/value_factory.h"
+
+// These benchmarks take a while and assert little, so they are disabled. Run them with --gtest_also_run_disabled_tests.
+
+namespace bustub {
+
+/**
+ * Repeatedly fetch and unpin pages that are already resident from num_threads threads.
+ * @return the number of fetch/unpin pairs completed per second
+ */
+static double RunHitWorkload(BufferPoolManager *bpm, const std::vector<page_id_t> &page_ids, size_t num_threads,
+                             size_t ops_per_thread) {
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t thread_itr = 0; thread_itr < num_threads; ++thread_itr) {
+    threads.emplace_back([&, thread_itr] {
+      std::default_random_engine rng(thread_itr);
+      std::uniform_int_distribution<size_t> uniform_dist(0, page_ids.size() - 1);
+      for (size_t i = 0; i < ops_per_thread; ++i) {
+        page_id_t page_id = page_ids[uniform_dist(rng)];
+        Page *page = bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(page_id, page->GetPageId());
+        EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<double>(num_threads * ops_per_thread) / elapsed.count();
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerBenchmarkTest, DISABLED_HitThroughputTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 64;
+  const size_t num_instances = 4;
+  const size_t ops_per_thread = 50000;
+
+  auto *disk_manager = new DiskManager(db_name);
+  std::vector<std::pair<std::string, BufferPoolManager *>> bpms = {
+      {"instance", new BufferPoolManagerInstance(buffer_pool_size * num_instances, disk_manager)},
+      {"parallel", new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager)}};
+
+  for (auto &[name, bpm] : bpms) {
+    // Fill the whole pool so that every fetch below is a hit.
+    std::vector<page_id_t> page_ids;
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < buffer_pool_size * num_instances; ++i) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+      page_ids.push_back(page_id_temp);
+      EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+    }
+
+    for (size_t num_threads : {1, 2, 4, 8}) {
+      double throughput = RunHitWorkload(bpm, page_ids, num_threads, ops_per_thread);
+      std::cout << "[ BENCHMARK ] " << name << " hit path, " << num_threads << " threads: " << throughput
+                << " fetches/s" << std::endl;
+    }
+    BufferPoolStats stats = bpm->GetStats();
+    std::cout << "[ BENCHMARK ] " << name << " hit path: hit ratio " << stats.HitRatio() << ", " << stats.latch_waits_
+              << " latch waits, " << stats.latch_wait_ns_ / 1000 << " us waited" << std::endl;
+
+    // Every pin was released again, so the whole pool must still be evictable.
+    for (size_t i = 0; i < page_ids.size(); ++i) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    }
+    delete bpm;
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerBenchmarkTest, DISABLED_ScanResistanceTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 64;
+  const size_t num_hot_pages = 16;
+  const size_t num_table_pages = 512;
+  const size_t scan_length = 128;
+  const size_t num_rounds = 50;
+  const size_t lookups_per_round = 200;
+
+  for (auto [name, replacer_type] : {std::make_pair("lru", ReplacerType::LRU),
+                                     std::make_pair("lru-k", ReplacerType::LRU_K)}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, replacer_type);
+
+    // The first pages play the role of index pages, the rest that of a table that gets scanned.
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < num_hot_pages + num_table_pages; ++i) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+      EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+    }
+
+    // Each round does point lookups on the hot pages and then scans a stretch of the table.
+    std::default_random_engine rng(0);
+    std::uniform_int_distribution<page_id_t> hot_dist(0, num_hot_pages - 1);
+    int reads_before = disk_manager->GetNumReads();
+    size_t hot_reads = 0;
+    for (size_t round = 0; round < num_rounds; ++round) {
+      for (size_t i = 0; i < lookups_per_round; ++i) {
+        int reads = disk_manager->GetNumReads();
+        page_id_t page_id = hot_dist(rng);
+        ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+        EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+        hot_reads += disk_manager->GetNumReads() - reads;
+      }
+      page_id_t scan_begin = num_hot_pages + (round * scan_length) % num_table_pages;
+      for (page_id_t page_id = scan_begin; page_id < scan_begin + static_cast<page_id_t>(scan_length); ++page_id) {
+        ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+        EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+      }
+    }
+    size_t num_fetches = num_rounds * (lookups_per_round + scan_length);
+    size_t num_reads = disk_manager->GetNumReads() - reads_before;
+    std::cout << "[ BENCHMARK ] " << name << " replacer, scans mixed with point lookups: hit ratio "
+              << 1.0 - static_cast<double>(num_reads) / num_fetches << ", point lookup hit ratio "
+              << 1.0 - static_cast<double>(hot_reads) / (num_rounds * lookups_per_round) << std::endl;
+
+    delete bpm;
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete disk_manager;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerBenchmarkTest, DISABLED_FlushAllPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 256;
+  const size_t num_instances = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  std::vector<std::pair<std::string, BufferPoolManager *>> bpms = {
+      {"instance", new BufferPoolManagerInstance(buffer_pool_size * num_instances, disk_manager)},
+      {"parallel", new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager)}};
+
+  for (auto &[name, bpm] : bpms) {
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < buffer_pool_size * num_instances; ++i) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+      EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+    }
+    int writes_before = disk_manager->GetNumWrites();
+    auto start = std::chrono::steady_clock::now();
+    bpm->FlushAllPages();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(buffer_pool_size * num_instances, disk_manager->GetNumWrites() - writes_before);
+    std::cout << "[ BENCHMARK ] " << name << " flush of " << buffer_pool_size * num_instances
+              << " dirty pages: " << elapsed.count() * 1000 << " ms" << std::endl;
+    delete bpm;
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerBenchmarkTest, DISABLED_ChecksumOverheadTest) {
+  const page_id_t num_pages = 1 << 14;
+  const size_t num_ops = 1 << 18;
+  std::vector<char> data(PAGE_SIZE, 'x');
+  std::vector<char> buf(PAGE_SIZE);
+
+  auto start = std::chrono::steady_clock::now();
+  uint32_t checksum = 0;
+  for (size_t i = 0; i < num_ops; ++i) {
+    memcpy(data.data(), &i, sizeof(i));
+    checksum += ChecksumUtil::Crc32c(data.data(), PAGE_SIZE);
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  EXPECT_NE(0, checksum);
+  std::cout << "[ BENCHMARK ] CRC32C of a page: " << elapsed.count() * 1e9 / num_ops << " ns, "
+            << num_ops * PAGE_SIZE / elapsed.count() / (1 << 30) << " GiB/s" << std::endl;
+
+  // The DiskManagerTest.ReadWritePageTest workload, scaled up: write a page, then read it back, on either backend.
+  for (DiskBackend backend : {DiskBackend::SYNC, DiskBackend::IO_URING}) {
+    for (bool checksums : {false, true}) {
+      remove("test.db");
+      remove("test.crc");
+      auto *disk_manager = new DiskManager("test.db", backend, false, checksums);
+      start = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < num_ops; ++i) {
+        auto page_id = static_cast<page_id_t>(i % num_pages);
+        disk_manager->WritePage(page_id, data.data());
+        disk_manager->ReadPage(page_id, buf.data());
+      }
+      elapsed = std::chrono::steady_clock::now() - start;
+      EXPECT_EQ(data, buf);
+      std::cout << "[ BENCHMARK ] " << num_ops << " page writes and reads on "
+                << (backend == DiskBackend::SYNC ? "SYNC" : "IO_URING") << (checksums ? " with" : " without")
+                << " checksums: " << elapsed.count() * 1e9 / num_ops << " ns per write and read" << std::endl;
+      disk_manager->ShutDown();
+      delete disk_manager;
+    }
+  }
+  remove("test.db");
+  remove("test.crc");
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerBenchmarkTest, DISABLED_CompressedSeqScanTest) {
+  const size_t buffer_pool_size = 16;
+  const size_t load_pool_size = 1024;
+  const int32_t num_rows = 10000;
+  const size_t num_scans = 5;
+  const std::vector<std::string> statuses = {"pending", "shipped", "delivered", "returned"};
+
+  for (bool compression : {false, true}) {
+    remove("test.db");
+    remove("test.cmap");
+    auto disk_manager = std::make_unique<DiskManager>("test.db", DiskBackend::IO_URING, false, false, compression);
+    // Inserting looks for space from the first page of the table on, so load the table with the whole of it resident.
+    auto bpm = std::make_unique<BufferPoolManagerInstance>(load_pool_size, disk_manager.get());
+    LockManager lock_manager;
+    TransactionManager txn_mgr(&lock_manager, nullptr);
+    Catalog catalog(bpm.get(), &lock_manager, nullptr);
+    Transaction *txn = txn_mgr.Begin(nullptr, IsolationLevel::READ_UNCOMMITTED);
+    ExecutorContext exec_ctx(txn, &catalog, bpm.get(), &txn_mgr, &lock_manager);
+    ExecutionEngine execution_engine(bpm.get(), &txn_mgr, &catalog);
+
+    // A generated table of orders: serial ids, a small range of customers and a few distinct status strings.
+    Schema schema({Column("id", TypeId::INTEGER), Column("customer", TypeId::INTEGER),
+                   Column("status", TypeId::VARCHAR, 16)});
+    TableInfo *table_info = catalog.CreateTable(txn, "orders", schema);
+    for (int32_t i = 0; i < num_rows; ++i) {
+      Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(i % 100),
+                   ValueFactory::GetVarcharValue(statuses[i % statuses.size()])},
+                  &schema);
+      RID rid;
+      ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn));
+    }
+    bpm->FlushAllPages();
+    ASSERT_TRUE(bpm->Resize(buffer_pool_size));
+
+    // The table is far larger than the buffer pool now, so every scan reads all of it from disk.
+    ColumnValueExpression id(0, 0, TypeId::INTEGER);
+    ColumnValueExpression customer(0, 1, TypeId::INTEGER);
+    Schema out_schema({Column("id", TypeId::INTEGER, &id), Column("customer", TypeId::INTEGER, &customer)});
+    SeqScanPlanNode plan{&out_schema, nullptr, table_info->oid_};
+    int reads_before = disk_manager->GetNumReads();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_scans; ++i) {
+      std::vector<Tuple> result_set;
+      ASSERT_TRUE(execution_engine.Execute(&plan, &result_set, txn, &exec_ctx));
+      ASSERT_EQ(num_rows, result_set.size());
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    int num_pages = disk_manager->GetNumPages();
+    EXPECT_GE(disk_manager->GetNumReads() - reads_before, num_pages);
+    std::cout << "[ BENCHMARK ] " << (compression ? "compressed" : "uncompressed") << " table of " << num_pages
+              << " pages: " << disk_manager->GetStoredBytes() / 1024 << " KB stored ("
+              << 100.0 * disk_manager->GetStoredBytes() / (static_cast<double>(num_pages) * PAGE_SIZE)
+              << "% of the pages), seq scan " << num_rows * num_scans / elapsed.count() << " rows/s" << std::endl;
+
+    txn_mgr.Commit(txn);
+    delete txn;
+    bpm.reset();
+    disk_manager->ShutDown();
+  }
+  remove("test.db");
+  remove("test.cmap");
+  remove("test.log");
+}
+
+/*
+ * The page size is fixed at build time, so compare sizes by running this test in builds configured with
+ * -DBUSTUB_PAGE_SIZE=4096, 8192, 16384 and 65536. The buffer pools get the same number of bytes in each build.
+ */
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerBenchmarkTest, DISABLED_PageSizeTest) {
+  const size_t scan_pool_bytes = 256 << 10;
+  const size_t index_pool_bytes = 1 << 20;
+  const size_t load_pool_size = (4 << 20) / PAGE_SIZE;
+  const int32_t num_rows = 20000;
+  const size_t num_scans = 5;
+  const int num_keys = 20000;
+
+  remove("test.db");
+  auto disk_manager = std::make_unique<DiskManager>("test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(load_pool_size, disk_manager.get());
+  LockManager lock_manager;
+  TransactionManager txn_mgr(&lock_manager, nullptr);
+  Catalog catalog(bpm.get(), &lock_manager, nullptr);
+  Transaction *txn = txn_mgr.Begin(nullptr, IsolationLevel::READ_UNCOMMITTED);
+  ExecutorContext exec_ctx(txn, &catalog, bpm.get(), &txn_mgr, &lock_manager);
+  ExecutionEngine execution_engine(bpm.get(), &txn_mgr, &catalog);
+
+  Schema schema({Column("id", TypeId::INTEGER), Column("customer", TypeId::INTEGER)});
+  TableInfo *table_info = catalog.CreateTable(txn, "orders", schema);
+  for (int32_t i = 0; i < num_rows; ++i) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(i % 100)}, &schema);
+    RID rid;
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn));
+  }
+  bpm->FlushAllPages();
+  ASSERT_TRUE(bpm->Resize(scan_pool_bytes / PAGE_SIZE));
+  int num_table_pages = disk_manager->GetNumPages();
+
+  // Scan: larger pages mean fewer, larger reads for the same rows.
+  ColumnValueExpression id(0, 0, TypeId::INTEGER);
+  Schema out_schema({Column("id", TypeId::INTEGER, &id)});
+  SeqScanPlanNode plan{&out_schema, nullptr, table_info->oid_};
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_scans; ++i) {
+    std::vector<Tuple> result_set;
+    ASSERT_TRUE(execution_engine.Execute(&plan, &result_set, txn, &exec_ctx));
+    ASSERT_EQ(num_rows, result_set.size());
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << "[ BENCHMARK ] " << PAGE_SIZE << "-byte pages: table of " << num_table_pages << " pages, seq scan "
+            << num_rows * num_scans / elapsed.count() << " rows/s" << std::endl;
+
+  // Hash index: larger pages mean larger buckets, so fewer splits but longer searches within a bucket.
+  ASSERT_TRUE(bpm->Resize(index_pool_bytes / PAGE_SIZE));
+  ExtendibleHashTable<int, int, IntComparator> hash_table("index", bpm.get(), IntComparator(), HashFunction<int>());
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_keys; ++i) {
+    ASSERT_TRUE(hash_table.Insert(nullptr, i, i));
+  }
+  std::chrono::duration<double> insert_elapsed = std::chrono::steady_clock::now() - start;
+  start = std::chrono::steady_clock::now();
+  std::vector<int> result;
+  for (int i = 0; i < num_keys; ++i) {
+    result.clear();
+    hash_table.GetValue(nullptr, i, &result);
+    ASSERT_EQ(1, result.size());
+  }
+  std::chrono::duration<double> lookup_elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << "[ BENCHMARK ] " << PAGE_SIZE << "-byte pages: hash index of global depth "
+            << hash_table.GetGlobalDepth() << ", " << num_keys / insert_elapsed.count() << " inserts/s, "
+            << num_keys / lookup_elapsed.count() << " lookups/s" << std::endl;
+
+  txn_mgr.Commit(txn);
+  delete txn;
+  bpm.reset();
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+}
+
+/**
+ * Run the LRUReplacerTest.SampleTest workload, scaled up: every thread unpins and pins random frames of its own slice
+ * of the replacer, and victimizes a frame every eighth operation.
+ * @return the number of replacer calls completed per second
+ */
+static double RunReplacerWorkload(Replacer *replacer, size_t num_frames, size_t num_threads, size_t ops_per_thread) {
+  for (size_t i = 0; i < num_frames; ++i) {
+    replacer->Unpin(static_cast<frame_id_t>(i));
+  }
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t thread_itr = 0; thread_itr < num_threads; ++thread_itr) {
+    threads.emplace_back([&, thread_itr] {
+      std::default_random_engine rng(thread_itr);
+      size_t slice = num_frames / num_threads;
+      std::uniform_int_distribution<size_t> uniform_dist(thread_itr * slice, (thread_itr + 1) * slice - 1);
+      for (size_t i = 0; i < ops_per_thread; ++i) {
+        auto frame_id = static_cast<frame_id_t>(uniform_dist(rng));
+        replacer->Pin(frame_id);
+        replacer->Unpin(frame_id);
+        if (i % 8 == 0) {
+          frame_id_t victim;
+          ASSERT_TRUE(replacer->Victim(&victim));
+          replacer->Unpin(victim);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  EXPECT_EQ(num_frames, replacer->Size());
+  return static_cast<double>(num_threads * ops_per_thread * 9 / 4) / elapsed.count();
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerBenchmarkTest, DISABLED_ReplacerThroughputTest) {
+  const size_t num_frames = 1 << 14;
+  const size_t ops_per_thread = 100000;
+
+  for (size_t num_threads : {1, 2, 4, 8}) {
+    std::vector<std::pair<std::string, Replacer *>> replacers = {{"lru", new LRUReplacer(num_frames)},
+                                                                 {"lru-k", new LRUKReplacer(num_frames)},
+                                                                 {"clock", new ClockReplacer(num_frames)}};
+    for (auto &[name, replacer] : replacers) {
+      double throughput = RunReplacerWorkload(replacer, num_frames, num_threads, ops_per_thread);
+      std::cout << "[ BENCHMARK ] " << name << " replacer, " << num_threads << " threads: " << throughput
+                << " calls/s" << std::endl;
+      delete replacer;
+    }
+  }
+}
+
+}  // namespace bustub
@@ -11,16 +11,20 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/buffer_pool_manager_instance.h"
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
 
 namespace bustub {
 
-// NOLINTNEXTLINE
 // Check whether pages containing terminal characters can be recovered
+// NOLINTNEXTLINE
 TEST(BufferPoolManagerInstanceTest, BinaryDataTest) {
   const std::string db_name = "test.db";
   const size_t buffer_pool_size = 10;
@@ -141,4 +145,607 @@ TEST(BufferPoolManagerInstanceTest, SampleTest) {
   delete disk_manager;
 }
 
+// Hits are served under a shared latch while misses evict, so hammer both paths at once and check page contents.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ConcurrentFetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const int num_pages = 64;
+  const size_t num_threads = 8;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, page_id_temp);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  std::vector<std::thread> threads;
+  for (size_t thread_itr = 0; thread_itr < num_threads; ++thread_itr) {
+    threads.emplace_back([bpm, thread_itr] {
+      std::default_random_engine rng(thread_itr);
+      std::uniform_int_distribution<int> uniform_dist(0, num_pages - 1);
+      char expected[PAGE_SIZE];
+      for (int i = 0; i < 2000; ++i) {
+        page_id_t page_id = uniform_dist(rng);
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          // Every frame is pinned by the other threads right now.
+          continue;
+        }
+        snprintf(expected, PAGE_SIZE, "page %d", page_id);
+        page->RLatch();
+        EXPECT_EQ(page_id, page->GetPageId());
+        EXPECT_EQ(0, strcmp(page->GetData(), expected));
+        page->RUnlatch();
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, i % 2 == 0));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Scenario: all pins were released, so every frame can be handed out again.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// Dirty victims are written back without the latch held, so a page that is read back in right after being evicted
+// must never see stale contents. Every thread bumps per-page counters; no increment may be lost.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ConcurrentWriteBackTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const int num_pages = 32;
+  const size_t num_threads = 8;
+  const int increments_per_thread = 1000;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  std::vector<std::thread> threads;
+  for (size_t thread_itr = 0; thread_itr < num_threads; ++thread_itr) {
+    threads.emplace_back([bpm, thread_itr] {
+      std::default_random_engine rng(thread_itr);
+      std::uniform_int_distribution<int> uniform_dist(0, num_pages - 1);
+      int done = 0;
+      while (done < increments_per_thread) {
+        page_id_t page_id = uniform_dist(rng);
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        page->WLatch();
+        ++*reinterpret_cast<int *>(page->GetData());
+        page->WUnlatch();
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+        ++done;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  int total = 0;
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    total += *reinterpret_cast<int *>(page->GetData());
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  EXPECT_EQ(static_cast<int>(num_threads) * increments_per_thread, total);
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PageCleanerTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: fill the pool with dirty, unpinned pages.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: the cleaner writes them all out in the background.
+  bpm->RunPageCleaner(0, buffer_pool_size);
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  bool all_clean = false;
+  while (!all_clean && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    all_clean = true;
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      all_clean = all_clean && !bpm->GetPages()[i].IsDirty();
+    }
+  }
+  bpm->StopPageCleaner();
+  EXPECT_TRUE(all_clean);
+
+  // Scenario: evicting those pages does not have to write anything back, and their contents made it to disk.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  EXPECT_EQ(buffer_pool_size, bpm->GetCleanEvictions());
+  EXPECT_EQ(0, bpm->GetDirtyEvictions());
+  auto *page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "page 0"));
+  EXPECT_EQ(buffer_pool_size + 1, bpm->GetCleanEvictions());
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PrefetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t num_prefetched = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: write twice as many pages as fit in the pool, so that the first ones are evicted to disk.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < 2 * buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: pages that were never allocated are not read in.
+  bpm->Prefetch(2 * buffer_pool_size, buffer_pool_size);
+
+  // Scenario: the evicted pages are read back in by the prefetch thread without being fetched, which is neither a hit
+  // nor a miss.
+  BufferPoolStats stats = bpm->GetStats();
+  bpm->Prefetch(0, num_prefetched);
+  auto is_resident = [&](page_id_t page_id) {
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      if (bpm->GetPages()[i].GetPageId() == page_id) {
+        return true;
+      }
+    }
+    return false;
+  };
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  bool all_resident = false;
+  while (!all_resident && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    all_resident = true;
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_prefetched); ++page_id) {
+      all_resident = all_resident && is_resident(page_id);
+    }
+  }
+  EXPECT_TRUE(all_resident);
+  EXPECT_FALSE(is_resident(2 * buffer_pool_size));
+  EXPECT_EQ(stats.hits_, bpm->GetStats().hits_);
+  EXPECT_EQ(stats.misses_, bpm->GetStats().misses_);
+
+  // Scenario: prefetched pages are unpinned, hold their contents, and fetching them is a hit.
+  size_t evictions = bpm->GetCleanEvictions() + bpm->GetDirtyEvictions();
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_prefetched); ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_EQ(0, strcmp(page->GetData(), ("page " + std::to_string(page_id)).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(evictions, bpm->GetCleanEvictions() + bpm->GetDirtyEvictions());
+  EXPECT_EQ(stats.hits_ + num_prefetched, bpm->GetStats().hits_);
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, HugePageArenaTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 1024;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, ReplacerType::LRU, true);
+
+  // Scenario: the frames are contiguous and page-aligned, whether or not the system could provide huge pages.
+  Page *pages = bpm->GetPages();
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(pages[0].GetData()) % PAGE_SIZE);
+  for (size_t i = 1; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(pages[i - 1].GetData() + PAGE_SIZE, pages[i].GetData());
+  }
+
+  // Scenario: pages written through the arena survive eviction and come back intact.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < 2 * buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(2 * buffer_pool_size); page_id += 97) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), ("page " + std::to_string(page_id)).c_str()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, FetchPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: write twice as many pages as fit in the pool, so that pages 0-9 are on disk and 10-19 are resident.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < 2 * buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: a batch mixing hits, misses and a duplicate only reads each missing page once.
+  std::vector<page_id_t> page_ids = {3, 15, 4, 16, 5, 3};
+  std::vector<Page *> pages(page_ids.size());
+  int reads = disk_manager->GetNumReads();
+  EXPECT_EQ(page_ids.size(), bpm->FetchPages(page_ids, pages.data()));
+  EXPECT_EQ(reads + 3, disk_manager->GetNumReads());
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ(page_ids[i], pages[i]->GetPageId());
+    EXPECT_EQ(0, strcmp(pages[i]->GetData(), ("page " + std::to_string(page_ids[i])).c_str()));
+  }
+  EXPECT_EQ(2, pages[0]->GetPinCount());
+
+  // Scenario: unpinning the batch releases every pin it took, and no more.
+  EXPECT_EQ(true, bpm->UnpinPages(page_ids, false));
+  EXPECT_EQ(0, pages[0]->GetPinCount());
+  EXPECT_EQ(false, bpm->UnpinPages({3}, false));
+
+  // Scenario: a batch larger than the pool fetches as many pages as there are frames.
+  page_ids.clear();
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size + 2); ++page_id) {
+    page_ids.push_back(page_id);
+  }
+  pages.resize(page_ids.size());
+  EXPECT_EQ(buffer_pool_size, bpm->FetchPages(page_ids, pages.data()));
+  std::vector<page_id_t> fetched;
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    if (pages[i] != nullptr) {
+      EXPECT_EQ(0, strcmp(pages[i]->GetData(), ("page " + std::to_string(page_ids[i])).c_str()));
+      fetched.push_back(page_ids[i]);
+    }
+  }
+  EXPECT_EQ(true, bpm->UnpinPages(fetched, false));
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, PageReuseTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < 6; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: deleted pages are handed out again, lowest first, before the file grows.
+  EXPECT_EQ(true, bpm->DeletePage(3));
+  EXPECT_EQ(true, bpm->DeletePage(1));
+  EXPECT_EQ(true, bpm->DeletePage(100));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(1, page_id_temp);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(3, page_id_temp);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(6, page_id_temp);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+
+  // Scenario: free pages are remembered across a restart, and new pages do not overwrite existing ones.
+  bpm->FlushAllPages();
+  EXPECT_EQ(true, bpm->DeletePage(2));
+  EXPECT_EQ(true, bpm->DeletePage(4));
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+  disk_manager = new DiskManager(db_name);
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  for (page_id_t expected_page_id : {2, 4, 7}) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(expected_page_id, page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+
+  // Shutdown the disk manager and remove the temporary files we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t max_pool_size = 16;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, ReplacerType::LRU, false,
+                                            max_pool_size);
+  EXPECT_EQ(false, bpm->Resize(0));
+  EXPECT_EQ(false, bpm->Resize(max_pool_size + 1));
+
+  // Scenario: growing the pool makes room for more pinned pages.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(true, bpm->Resize(max_pool_size));
+  EXPECT_EQ(max_pool_size, bpm->GetPoolSize());
+  for (size_t i = buffer_pool_size; i < max_pool_size; ++i) {
+    Page *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: shrinking waits for the pages in the removed frames to be unpinned, and writes the dirty ones back.
+  std::thread unpinner([&] {
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(max_pool_size); ++page_id) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    }
+  });
+  EXPECT_EQ(true, bpm->Resize(buffer_pool_size));
+  unpinner.join();
+  EXPECT_EQ(buffer_pool_size, bpm->GetPoolSize());
+  EXPECT_EQ(buffer_pool_size, bpm->GetNumAvailableFrames());
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  for (page_id_t page_id = static_cast<page_id_t>(max_pool_size);
+       page_id < static_cast<page_id_t>(max_pool_size + buffer_pool_size); ++page_id) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: the pages that were evicted by the shrink still have their data.
+  char expected[PAGE_SIZE];
+  for (page_id_t page_id = static_cast<page_id_t>(buffer_pool_size); page_id < static_cast<page_id_t>(max_pool_size);
+       ++page_id) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(0, strcmp(expected, page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: a hot page in a removed frame does not hold up a shrink. Two threads keep pinning it in turn, and once it
+  // is out of the page table their fetches read it into one of the remaining frames.
+  EXPECT_EQ(true, bpm->Resize(max_pool_size));
+  const page_id_t hot_page_id = 5;
+  Page *hot_page = bpm->FetchPage(hot_page_id);
+  ASSERT_NE(nullptr, hot_page);
+  EXPECT_LE(buffer_pool_size, static_cast<size_t>(hot_page - bpm->GetPages()));
+  std::atomic<bool> stop_readers{false};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 2; ++i) {
+    readers.emplace_back([&] {
+      while (!stop_readers) {
+        Page *page = bpm->FetchPage(hot_page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(0, strcmp("page 5", page->GetData()));
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        EXPECT_EQ(true, bpm->UnpinPage(hot_page_id, false));
+      }
+    });
+  }
+  EXPECT_EQ(true, bpm->UnpinPage(hot_page_id, false));
+  EXPECT_EQ(true, bpm->Resize(buffer_pool_size));
+  hot_page = bpm->FetchPage(hot_page_id);
+  ASSERT_NE(nullptr, hot_page);
+  EXPECT_GT(buffer_pool_size, static_cast<size_t>(hot_page - bpm->GetPages()));
+  EXPECT_EQ(true, bpm->UnpinPage(hot_page_id, false));
+  stop_readers = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, StatsTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: new pages are neither hits nor misses, but evicting dirty ones writes them back in the background.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < 2 * buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  BufferPoolStats stats = bpm->GetStats();
+  EXPECT_EQ(0, stats.hits_);
+  EXPECT_EQ(0, stats.misses_);
+  EXPECT_EQ(buffer_pool_size, stats.dirty_evictions_);
+
+  // Scenario: resident pages are hits, the others are misses and each read lands in the latency histogram.
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(2 * buffer_pool_size); ++page_id) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  std::vector<page_id_t> page_ids = {0, 1, 2};
+  std::vector<Page *> pages(page_ids.size());
+  EXPECT_EQ(page_ids.size(), bpm->FetchPages(page_ids, pages.data()));
+  EXPECT_EQ(true, bpm->UnpinPages(page_ids, false));
+  stats = bpm->GetStats();
+  EXPECT_EQ(0, stats.hits_);
+  EXPECT_EQ(2 * buffer_pool_size + page_ids.size(), stats.misses_);
+  EXPECT_EQ(0, stats.HitRatio());
+  uint64_t num_reads = 0;
+  uint64_t num_writes = 0;
+  for (size_t i = 0; i < BufferPoolStats::NUM_LATENCY_BUCKETS; ++i) {
+    num_reads += stats.read_latency_[i];
+    num_writes += stats.write_latency_[i];
+  }
+  // Each page read records one latency, FetchPages included, which records one per page it reads.
+  EXPECT_EQ(2 * buffer_pool_size + page_ids.size(), num_reads);
+  EXPECT_EQ(2 * buffer_pool_size, stats.page_writes_);
+  EXPECT_EQ(stats.page_writes_, num_writes);
+  EXPECT_EQ(stats.dirty_evictions_, bpm->GetDirtyEvictions());
+  EXPECT_EQ(stats.clean_evictions_, bpm->GetCleanEvictions());
+
+  ASSERT_NE(nullptr, bpm->FetchPage(2));
+  EXPECT_EQ(true, bpm->UnpinPage(2, false));
+  EXPECT_EQ(1, bpm->GetStats().hits_);
+
+  // Scenario: the histogram buckets are powers of two in microseconds.
+  EXPECT_EQ(0, BufferPoolStats::LatencyBucket(std::chrono::nanoseconds(1500)));
+  EXPECT_EQ(1, BufferPoolStats::LatencyBucket(std::chrono::microseconds(3)));
+  EXPECT_EQ(10, BufferPoolStats::LatencyBucket(std::chrono::microseconds(1024)));
+  EXPECT_EQ(BufferPoolStats::NUM_LATENCY_BUCKETS - 1, BufferPoolStats::LatencyBucket(std::chrono::seconds(10)));
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, CorruptPageTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  remove("test.crc");
+
+  auto *disk_manager = new DiskManager(db_name, DiskBackend::SYNC, false, true);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FlushAllPages();
+  delete bpm;
+
+  // Change pages 1 and 2 on disk behind the disk manager's back.
+  FILE *db = fopen(db_name.c_str(), "r+b");
+  ASSERT_NE(nullptr, db);
+  for (page_id_t page_id : {1, 2}) {
+    fseek(db, page_id * PAGE_SIZE + 100, SEEK_SET);
+    fputc('x', db);
+  }
+  fclose(db);
+
+  // Scenario: a page that does not match its checksum cannot be fetched, one page at a time or in a batch, and the
+  // frames it was read into go back to the pool.
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  EXPECT_EQ(nullptr, bpm->FetchPage(1));
+  std::vector<page_id_t> page_ids = {0, 2, 3};
+  std::vector<Page *> pages(page_ids.size());
+  EXPECT_EQ(2, bpm->FetchPages(page_ids, pages.data()));
+  EXPECT_NE(nullptr, pages[0]);
+  EXPECT_EQ(nullptr, pages[1]);
+  EXPECT_EQ(0, strcmp(pages[2]->GetData(), "page 3"));
+  EXPECT_EQ(2, disk_manager->GetNumChecksumFailures());
+  EXPECT_EQ(buffer_pool_size - 2, bpm->GetNumAvailableFrames());
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  EXPECT_EQ(true, bpm->UnpinPage(3, false));
+
+  // Scenario: the page is read again on the next fetch, and fails again.
+  EXPECT_EQ(nullptr, bpm->FetchPage(2));
+  EXPECT_EQ(3, disk_manager->GetNumChecksumFailures());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.crc");
+
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
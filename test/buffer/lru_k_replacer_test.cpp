@@ -0,0 +1,105 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer_test.cpp
+//
+// Identification: test/buffer/lru_k_replacer_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+
+#include "buffer/lru_k_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(7, 2);
+
+  // Scenario: unpin six elements, i.e. add them to the replacer. Frame 1 is used twice, all others once.
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Unpin(2);
+  lru_k_replacer.Unpin(3);
+  lru_k_replacer.Unpin(4);
+  lru_k_replacer.Unpin(5);
+  lru_k_replacer.Unpin(6);
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Unpin(1);
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // Scenario: unpinning an evictable frame again does not count as another access.
+  lru_k_replacer.Unpin(2);
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // Scenario: frames with fewer than two accesses go first, even though frame 1 was used before them.
+  int value;
+  EXPECT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+  EXPECT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+  EXPECT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(4, value);
+
+  // Scenario: pin elements in the replacer.
+  // Note that 3 has already been victimized, so pinning 3 should have no effect.
+  lru_k_replacer.Pin(3);
+  lru_k_replacer.Pin(5);
+  EXPECT_EQ(2, lru_k_replacer.Size());
+
+  // Scenario: unpin 5, which gives it a second access.
+  lru_k_replacer.Unpin(5);
+
+  // Scenario: continue looking for victims. Frame 6 still has a single access, so it goes first. Of the frames with two
+  // accesses, 1 goes before 5 because its second most recent access is older.
+  EXPECT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(6, value);
+  EXPECT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  EXPECT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(5, value);
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(0, lru_k_replacer.Size());
+
+  // Scenario: victimized frames are about to hold other pages, so their history starts over. Each now has a single
+  // access and they go in the order they were unpinned, not by their earlier accesses.
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Unpin(5);
+  lru_k_replacer.Unpin(6);
+  EXPECT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  EXPECT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(5, value);
+  EXPECT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(6, value);
+
+  // Scenario: removing a frame also starts its history over, so frame 1 goes before frame 2 again.
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Remove(1);
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Unpin(2);
+  EXPECT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  EXPECT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+
+  // Scenario: the first real access of a prefetched frame replaces the prefetch rather than adding to it. Frame 3 thus
+  // has a single access and goes before frame 4, which was used twice before it.
+  lru_k_replacer.Unpin(4);
+  lru_k_replacer.Pin(4);
+  lru_k_replacer.Unpin(4);
+  lru_k_replacer.UnpinPrefetched(3);
+  lru_k_replacer.Pin(3);
+  lru_k_replacer.Unpin(3);
+  EXPECT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+  EXPECT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(4, value);
+}
+
+}  // namespace bustub
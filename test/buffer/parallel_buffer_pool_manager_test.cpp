@@ -11,16 +11,18 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/parallel_buffer_pool_manager.h"
+#include <algorithm>
 #include <cstdio>
 #include <random>
 #include <string>
+#include <vector>
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
 
 namespace bustub {
 
-// NOLINTNEXTLINE
 // Check whether pages containing terminal characters can be recovered
+// NOLINTNEXTLINE
 TEST(ParallelBufferPoolManagerTest, BinaryDataTest) {
   const std::string db_name = "test.db";
   const size_t buffer_pool_size = 10;
@@ -151,4 +153,200 @@ TEST(ParallelBufferPoolManagerTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, FetchPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t num_instances = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  // Scenario: write more pages than fit in the pool, so that the first ones are evicted to disk.
+  std::vector<page_id_t> page_ids;
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < 2 * buffer_pool_size * num_instances; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    if (i % 3 == 0) {
+      page_ids.push_back(page_id_temp);
+    }
+  }
+
+  // Scenario: a batch spread over all instances comes back in the order it was asked for.
+  std::vector<Page *> pages(page_ids.size());
+  EXPECT_EQ(page_ids.size(), bpm->FetchPages(page_ids, pages.data()));
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ(page_ids[i], pages[i]->GetPageId());
+    EXPECT_EQ(0, strcmp(pages[i]->GetData(), ("page " + std::to_string(page_ids[i])).c_str()));
+  }
+  EXPECT_EQ(true, bpm->UnpinPages(page_ids, false));
+  EXPECT_EQ(false, bpm->UnpinPages(page_ids, false));
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, PageReuseTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t num_instances = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < 2 * num_instances; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+
+  // Scenario: every instance reuses the deleted pages that map to it, so one round of allocations gets both back.
+  EXPECT_EQ(true, bpm->DeletePage(3));
+  EXPECT_EQ(true, bpm->DeletePage(7));
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_instances; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    page_ids.push_back(page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  EXPECT_NE(page_ids.end(), std::find(page_ids.begin(), page_ids.end(), 3));
+  EXPECT_NE(page_ids.end(), std::find(page_ids.begin(), page_ids.end(), 7));
+
+  // Shutdown the disk manager and remove the temporary files we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, AdaptiveAllocationTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t num_instances = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  // Scenario: with rebalancing, pinned new pages spread evenly, because each goes to the emptiest instance.
+  bpm->SetRebalancing(true);
+  std::vector<size_t> pages_per_instance(num_instances, 0);
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size * num_instances / 2; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    ++pages_per_instance[page_id_temp % num_instances];
+  }
+  for (size_t i = 0; i < num_instances; ++i) {
+    EXPECT_EQ(buffer_pool_size / 2, pages_per_instance[i]);
+  }
+
+  // Scenario: without rebalancing, full instances are skipped until every frame holds a pinned page.
+  bpm->SetRebalancing(false);
+  for (size_t i = 0; i < buffer_pool_size * num_instances / 2; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 2;
+  const size_t max_pool_size = 4;
+  const size_t num_instances = 3;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager, nullptr, ReplacerType::LRU,
+                                            false, max_pool_size);
+  EXPECT_EQ(buffer_pool_size * num_instances, bpm->GetPoolSize());
+  EXPECT_EQ(false, bpm->Resize(num_instances - 1));
+  EXPECT_EQ(false, bpm->Resize(max_pool_size * num_instances + 1));
+
+  // Scenario: the new frames are spread over the instances and can all hold pinned pages.
+  EXPECT_EQ(true, bpm->Resize(max_pool_size * num_instances - 1));
+  EXPECT_EQ(max_pool_size * num_instances - 1, bpm->GetPoolSize());
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < max_pool_size * num_instances - 1; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+
+  // Scenario: shrinking takes the unpinned pages out of the removed frames.
+  EXPECT_EQ(true, bpm->Resize(num_instances));
+  EXPECT_EQ(num_instances, bpm->GetPoolSize());
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fsm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, FlushAllPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const size_t num_instances = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  // Scenario: every dirty page is written exactly once, while some of them are still pinned. New pages may not spread
+  // evenly over the instances, so a few may have been written already when they were evicted.
+  int writes_before = disk_manager->GetNumWrites();
+  page_id_t page_id_temp;
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size * num_instances; ++i) {
+    Page *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    page_ids.push_back(page_id_temp);
+    // Odd pages keep a pin.
+    if (i % 2 == 1) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id_temp));
+    }
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FlushAllPages();
+  EXPECT_EQ(buffer_pool_size * num_instances, disk_manager->GetNumWrites() - writes_before);
+  bpm->FlushAllPages();
+  EXPECT_EQ(buffer_pool_size * num_instances, disk_manager->GetNumWrites() - writes_before);
+
+  // Scenario: the data made it to disk.
+  char data[PAGE_SIZE];
+  char expected[PAGE_SIZE];
+  for (page_id_t page_id : page_ids) {
+    disk_manager->ReadPage(page_id, data);
+    snprintf(expected, PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(0, strcmp(expected, data));
+  }
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
@@ -0,0 +1,125 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_only_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/read_only_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/read_only_buffer_pool_manager.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ReadOnlyBufferPoolManagerTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const page_id_t num_pages = 25;
+  remove(db_name.c_str());
+
+  // Write the pages through a regular buffer pool first.
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  bpm->FlushAllPages();
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+
+  disk_manager = new DiskManager(db_name);
+  auto *read_only_bpm = new ReadOnlyBufferPoolManager(disk_manager);
+  EXPECT_EQ(static_cast<size_t>(num_pages), read_only_bpm->GetPoolSize());
+  read_only_bpm->AdviseAccessPattern(AccessPattern::SEQUENTIAL);
+  read_only_bpm->Prefetch(0, num_pages);
+
+  // Scenario: every page reads back, and fetching a page twice hands out the same view pinned twice.
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    auto *page = read_only_bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, page->GetPageId());
+    EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+  }
+  auto *page = read_only_bpm->FetchPage(3);
+  EXPECT_EQ(2, page->GetPinCount());
+  EXPECT_EQ(page, read_only_bpm->FetchPage(3));
+  EXPECT_FALSE(page->IsDirty());
+
+  // Scenario: pages are unpinned like in a regular buffer pool, but never as dirty.
+  EXPECT_FALSE(read_only_bpm->UnpinPage(3, true));
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(read_only_bpm->UnpinPage(3, false));
+  }
+  EXPECT_FALSE(read_only_bpm->UnpinPage(3, false));
+
+  // Scenario: nothing can be created, deleted or fetched beyond the end of the file.
+  page_id_t page_id;
+  EXPECT_EQ(nullptr, read_only_bpm->NewPage(&page_id));
+  EXPECT_FALSE(read_only_bpm->DeletePage(0));
+  EXPECT_EQ(nullptr, read_only_bpm->FetchPage(num_pages));
+  EXPECT_EQ(nullptr, read_only_bpm->FetchPage(INVALID_PAGE_ID));
+  EXPECT_EQ(0, disk_manager->GetNumReads());
+  delete read_only_bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+
+  // Scenario: a partial page at the end of the file, as a torn write leaves it, is not mapped.
+  FILE *db_file = fopen(db_name.c_str(), "ab");
+  ASSERT_NE(nullptr, db_file);
+  fputs("torn", db_file);
+  fclose(db_file);
+  disk_manager = new DiskManager(db_name);
+  read_only_bpm = new ReadOnlyBufferPoolManager(disk_manager);
+  EXPECT_EQ(static_cast<size_t>(num_pages), read_only_bpm->GetPoolSize());
+  EXPECT_EQ(nullptr, read_only_bpm->FetchPage(num_pages));
+  delete read_only_bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+
+  // Scenario: with checksums, a page changed behind the disk manager's back is not handed out.
+  disk_manager = new DiskManager(db_name, DiskBackend::SYNC, false, true);
+  std::vector<char> data(PAGE_SIZE);
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    snprintf(data.data(), PAGE_SIZE, "page %d", i);
+    disk_manager->WritePage(i, data.data());
+  }
+  disk_manager->ShutDown();
+  delete disk_manager;
+  db_file = fopen(db_name.c_str(), "r+b");
+  ASSERT_NE(nullptr, db_file);
+  fseek(db_file, 5 * PAGE_SIZE + 100, SEEK_SET);
+  fputc('x', db_file);
+  fclose(db_file);
+  disk_manager = new DiskManager(db_name, DiskBackend::SYNC, false, true);
+  read_only_bpm = new ReadOnlyBufferPoolManager(disk_manager);
+  EXPECT_EQ(nullptr, read_only_bpm->FetchPage(5));
+  EXPECT_EQ(nullptr, read_only_bpm->FetchPage(5));
+  EXPECT_EQ(2, disk_manager->GetNumChecksumFailures());
+  page = read_only_bpm->FetchPage(4);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ("page 4", std::string(page->GetData()));
+  EXPECT_TRUE(read_only_bpm->UnpinPage(4, false));
+
+  delete read_only_bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove(db_name.c_str());
+  remove("test.crc");
+}
+
+}  // namespace bustub
@@ -0,0 +1,179 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_benchmark_test.cpp
+//
+// Identification: test/container/hash_table_benchmark_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "container/hash/extendible_hash_table.h"
+#include "container/hash/hash_function.h"
+#include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
+#include "storage/index/int_comparator.h"
+#include "storage/page/hash_table_bucket_page.h"
+#include "test_util.h"  // NOLINT
+
+// These benchmarks take a while and assert little, so they are disabled. Run them with --gtest_also_run_disabled_tests.
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(HashTableBenchmarkTest, DISABLED_BulkLoadTest) {
+  const size_t buffer_pool_size = 256;
+  const int num_keys = 200000;
+
+  std::vector<std::pair<int, int>> entries;
+  for (int i = 0; i < num_keys; ++i) {
+    entries.emplace_back(i, i);
+  }
+  for (bool bulk_load : {false, true}) {
+    remove("test.db");
+    auto disk_manager = std::make_unique<DiskManager>("test.db");
+    auto bpm = std::make_unique<BufferPoolManagerInstance>(buffer_pool_size, disk_manager.get());
+    ExtendibleHashTable<int, int, IntComparator> hash_table("index", bpm.get(), IntComparator(), HashFunction<int>());
+    auto start = std::chrono::steady_clock::now();
+    if (bulk_load) {
+      ASSERT_TRUE(hash_table.BulkLoad(nullptr, entries));
+    } else {
+      for (const auto &[key, value] : entries) {
+        ASSERT_TRUE(hash_table.Insert(nullptr, key, value));
+      }
+    }
+    bpm->FlushAllPages();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "[ BENCHMARK ] hash index of " << num_keys << " keys " << (bulk_load ? "bulk loaded" : "inserted")
+              << ": " << num_keys / elapsed.count() << " keys/s, global depth " << hash_table.GetGlobalDepth() << ", "
+              << disk_manager->GetNumWrites() << " page writes" << std::endl;
+    bpm.reset();
+    disk_manager->ShutDown();
+  }
+  remove("test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableBenchmarkTest, DISABLED_GetValuesTest) {
+  const size_t buffer_pool_size = 64;
+  const int num_keys = 100000;
+  const size_t batch_size = 256;
+
+  remove("test.db");
+  auto disk_manager = std::make_unique<DiskManager>("test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(buffer_pool_size, disk_manager.get());
+  ExtendibleHashTable<int, int, IntComparator> hash_table("index", bpm.get(), IntComparator(), HashFunction<int>());
+  std::vector<std::pair<int, int>> entries;
+  for (int i = 0; i < num_keys; ++i) {
+    entries.emplace_back(i, i);
+  }
+  ASSERT_TRUE(hash_table.BulkLoad(nullptr, entries));
+
+  // Probe the index the way an index join probes it with its outer tuples, a batch at a time.
+  std::mt19937 gen(0);
+  std::vector<int> keys(num_keys);
+  for (auto &key : keys) {
+    key = static_cast<int>(gen() % num_keys);
+  }
+  for (bool batched : {false, true}) {
+    int reads_before = disk_manager->GetNumReads();
+    size_t num_matched = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t batch_begin = 0; batch_begin < keys.size(); batch_begin += batch_size) {
+      size_t batch_end = std::min(batch_begin + batch_size, keys.size());
+      std::vector<int> batch(keys.begin() + batch_begin, keys.begin() + batch_end);
+      if (batched) {
+        std::vector<std::vector<int>> results;
+        num_matched += hash_table.GetValues(nullptr, batch, &results);
+      } else {
+        for (int key : batch) {
+          std::vector<int> result;
+          num_matched += hash_table.GetValue(nullptr, key, &result) ? 1 : 0;
+        }
+      }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    ASSERT_EQ(keys.size(), num_matched);
+    std::cout << "[ BENCHMARK ] hash index of " << num_keys << " keys, "
+              << (batched ? "GetValues batches of " + std::to_string(batch_size) : std::string("GetValue per key"))
+              << ": " << keys.size() / elapsed.count() << " lookups/s, " << disk_manager->GetNumReads() - reads_before
+              << " page reads" << std::endl;
+  }
+
+  bpm.reset();
+  disk_manager->ShutDown();
+  remove("test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableBenchmarkTest, DISABLED_BucketProbeTest) {
+  using BucketPage = HashTableBucketPage<GenericKey<8>, RID, GenericComparator<8>>;
+  const size_t num_lookups = 50000;
+
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  HashFunction<GenericKey<8>> hash_fn;
+  auto make_key = [](int64_t i) {
+    GenericKey<8> key;
+    key.SetFromInteger(i);
+    return key;
+  };
+  std::vector<char> data(PAGE_SIZE);
+  auto *bucket_page = reinterpret_cast<BucketPage *>(data.data());
+  int64_t num_keys = 0;
+  for (; !bucket_page->IsFull(); ++num_keys) {
+    auto key = make_key(num_keys);
+    auto fingerprint = BucketPage::HashToFingerprint(hash_fn.GetHash(key));
+    ASSERT_TRUE(bucket_page->Insert(key, RID(num_keys), comparator, fingerprint));
+  }
+
+  // Half of the lookups hit, half miss. Keys are hashed up front, so that only the probe of the bucket is timed.
+  std::mt19937 gen(0);
+  std::vector<std::pair<GenericKey<8>, uint8_t>> lookups;
+  for (size_t i = 0; i < num_lookups; ++i) {
+    auto key = make_key(static_cast<int64_t>(gen() % (2 * num_keys)));
+    lookups.emplace_back(key, BucketPage::HashToFingerprint(hash_fn.GetHash(key)));
+  }
+
+  // Baseline: compare the key with every readable slot.
+  size_t num_found = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (const auto &[key, fingerprint] : lookups) {
+    for (uint32_t slot = 0; slot < num_keys; ++slot) {
+      if (bucket_page->IsReadable(slot) && comparator(key, bucket_page->KeyAt(slot)) == 0) {
+        ++num_found;
+      }
+    }
+  }
+  std::chrono::duration<double> scan_elapsed = std::chrono::steady_clock::now() - start;
+  size_t expected_found = num_found;
+
+  num_found = 0;
+  start = std::chrono::steady_clock::now();
+  for (const auto &[key, fingerprint] : lookups) {
+    std::vector<RID> result;
+    bucket_page->GetValue(key, comparator, &result, fingerprint);
+    num_found += result.size();
+  }
+  std::chrono::duration<double> probe_elapsed = std::chrono::steady_clock::now() - start;
+  ASSERT_EQ(expected_found, num_found);
+  std::cout << "[ BENCHMARK ] bucket of " << num_keys << " 8-byte keys: " << num_lookups / scan_elapsed.count()
+            << " lookups/s comparing every key, " << num_lookups / probe_elapsed.count()
+            << " lookups/s matching fingerprints first" << std::endl;
+}
+
+}  // namespace bustub
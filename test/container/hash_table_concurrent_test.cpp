@@ -406,6 +406,75 @@ void MixTest2Call() {
   }
 }
 
+void MixTest3Call() {
+  const size_t num_iters = 5;
+  const size_t num_threads = 32;
+  const size_t num_writers = num_threads / 2;
+  for (size_t iter = 0; iter < num_iters; iter++) {
+    auto *disk_manager = new DiskManager("test.db");
+    auto *bpm = new BufferPoolManagerInstance(100, disk_manager);
+    ExtendibleHashTable<int, int, IntComparator> hash_table("foo_pk", bpm, IntComparator(), HashFunction<int>());
+
+    // Add preserved_keys
+    std::vector<int> preserved_keys;
+    std::vector<int> dynamic_keys;
+    size_t total_keys = 40000;
+    size_t sieve = 4;
+    for (size_t i = 1; i <= total_keys; i++) {
+      if (i % sieve == 0) {
+        preserved_keys.emplace_back(i);
+      } else {
+        dynamic_keys.emplace_back(i);
+      }
+    }
+    InsertHelper(&hash_table, preserved_keys, 1);
+
+    // Half of the threads insert and then delete their share of the dynamic keys, splitting buckets as they go, while
+    // the other half keep looking up the preserved keys.
+    auto writer_task = [&](int tid) {
+      InsertHelperSplit(&hash_table, dynamic_keys, num_writers, tid, tid);
+      DeleteHelperSplit(&hash_table, dynamic_keys, num_writers, tid, tid);
+    };
+    auto lookup_task = [&](int tid) { LookupHelper(&hash_table, preserved_keys, tid); };
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < num_threads; i++) {
+      if (i % 2 == 0) {
+        threads.emplace_back(writer_task, i / 2);
+      } else {
+        threads.emplace_back(lookup_task, i / 2);
+      }
+    }
+    for (size_t i = 0; i < num_threads; i++) {
+      threads[i].join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    size_t num_ops = 2 * dynamic_keys.size() + (num_threads - num_writers) * preserved_keys.size();
+    std::cout << "[ BENCHMARK ] " << num_threads << " threads: " << num_ops / elapsed.count() << " ops/s, global depth "
+              << hash_table.GetGlobalDepth() << std::endl;
+
+    std::vector<int> result;
+    for (auto key : preserved_keys) {
+      result.clear();
+      hash_table.GetValue(nullptr, key, &result);
+      EXPECT_EQ(1, result.size());
+    }
+    for (auto key : dynamic_keys) {
+      result.clear();
+      EXPECT_FALSE(hash_table.GetValue(nullptr, key, &result));
+    }
+
+    hash_table.VerifyIntegrity();
+
+    // Cleanup
+    disk_manager->ShutDown();
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
 /*
  * Score: 5
  * Description: Concurrently insert a set of keys.
@@ -475,4 +544,13 @@ TEST(HashTableConcurrentTest2, MixTest2) {
   TEST_TIMEOUT_FAIL_END(3 * 1000 * 120)
 }
 
+/*
+ * Description: Insert and delete keys on 16 threads, splitting buckets, while 16 more threads look other keys up.
+ */
+TEST(HashTableConcurrentTest2, MixTest3) {
+  TEST_TIMEOUT_BEGIN
+  MixTest3Call();
+  TEST_TIMEOUT_FAIL_END(3 * 1000 * 120)
+}
+
 }  // namespace bustub
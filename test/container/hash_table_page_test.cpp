@@ -69,7 +69,7 @@ TEST(HashTablePageTest, BucketPageSampleTest) {
 
   // insert a few (key, value) pairs
   for (unsigned i = 0; i < 10; i++) {
-    assert(bucket_page->Insert(i, i, IntComparator()));
+    assert(bucket_page->Insert(i, i, IntComparator(), static_cast<uint8_t>(i)));
   }
 
   // check for the inserted pairs
@@ -81,7 +81,7 @@ TEST(HashTablePageTest, BucketPageSampleTest) {
   // remove a few pairs
   for (unsigned i = 0; i < 10; i++) {
     if (i % 2 == 1) {
-      assert(bucket_page->Remove(i, i, IntComparator()));
+      assert(bucket_page->Remove(i, i, IntComparator(), static_cast<uint8_t>(i)));
     }
   }
 
@@ -102,10 +102,25 @@ TEST(HashTablePageTest, BucketPageSampleTest) {
   // try to remove the already-removed pairs
   for (unsigned i = 0; i < 10; i++) {
     if (i % 2 == 1) {
-      assert(!bucket_page->Remove(i, i, IntComparator()));
+      assert(!bucket_page->Remove(i, i, IntComparator(), static_cast<uint8_t>(i)));
     }
   }
 
+  // fill the bucket up with pairs of their own fingerprints, which are only found under those fingerprints
+  int num_keys = 10;
+  for (; !bucket_page->IsFull(); num_keys++) {
+    EXPECT_TRUE(bucket_page->Insert(num_keys, num_keys, IntComparator(), static_cast<uint8_t>(num_keys)));
+  }
+  for (int i = 10; i < num_keys; i++) {
+    std::vector<int> result;
+    EXPECT_FALSE(bucket_page->GetValue(i, IntComparator(), &result, static_cast<uint8_t>(i + 1)));
+    EXPECT_FALSE(bucket_page->Remove(i, i, IntComparator(), static_cast<uint8_t>(i + 1)));
+    EXPECT_TRUE(bucket_page->GetValue(i, IntComparator(), &result, static_cast<uint8_t>(i)));
+    EXPECT_EQ(std::vector<int>{i}, result);
+  }
+  EXPECT_TRUE(bucket_page->Remove(num_keys - 1, num_keys - 1, IntComparator(), static_cast<uint8_t>(num_keys - 1)));
+  EXPECT_FALSE(bucket_page->IsFull());
+
   // unpin the directory page now that we are done
   bpm->UnpinPage(bucket_page_id, true, nullptr);
   disk_manager->ShutDown();
@@ -20,6 +20,7 @@
 #include <iostream>
 // NOLINTNEXTLINE
 #include <thread>
+#include <utility>
 #include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
@@ -279,12 +280,72 @@ void ScaleTestCall() {
   delete bpm;
 }
 
+// The number of pairs a bucket of KeyType and ValueType holds, which BUCKET_ARRAY_SIZE works out from those names.
+template <typename KeyType, typename ValueType>
+constexpr size_t BucketArraySize() {
+  return BUCKET_ARRAY_SIZE;
+}
+
+void LargeScaleTestCall(int num_keys, size_t pool_size) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(pool_size, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator> ht("foo_pk", bpm, IntComparator(), HashFunction<int>());
+
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_TRUE(ht.Insert(nullptr, i, i)) << "Failed to insert " << i;
+  }
+  // With more keys than the buckets of a one-page directory hold, the directory continues on segment pages.
+  if (static_cast<size_t>(num_keys) > DIRECTORY_ARRAY_SIZE * BucketArraySize<int, int>()) {
+    EXPECT_GT(1U << ht.GetGlobalDepth(), DIRECTORY_ARRAY_SIZE);
+  }
+  ht.VerifyIntegrity();
+
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+    EXPECT_EQ(1, res.size()) << "Missing kv pair for: " << i;
+  }
+
+  // Removing every key merges the buckets back and shrinks the directory into its page again.
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+  }
+  EXPECT_LE(1U << ht.GetGlobalDepth(), DIRECTORY_ARRAY_SIZE);
+  ht.VerifyIntegrity();
+  for (int i = 0; i < num_keys; i += 97) {
+    std::vector<int> res;
+    EXPECT_FALSE(ht.GetValue(nullptr, i, &res));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 /*
  * Score: 5
  * Description: Insert 200k keys to verify the table capacity
  */
 TEST(HashTableScaleTest, ScaleTest) { ScaleTestCall(); }
 
+/*
+ * Description: Insert 400k keys, which takes a directory of several pages
+ */
+TEST(HashTableScaleTest, LargeScaleTest) { LargeScaleTestCall(400000, 2048); }
+
+/*
+ * Description: Insert 100M keys. This takes a few GB of disk and a long time, so it only runs when asked for with
+ * --gtest_also_run_disabled_tests. The directory of 4 KB pages tops out at 2^17 buckets, too few for 100M int-int
+ * pairs, so it needs a build with larger pages.
+ */
+TEST(HashTableScaleTest, DISABLED_HundredMillionTest) {
+  if (PAGE_SIZE < 8192) {
+    GTEST_SKIP() << "needs pages of 8 KB or more";
+  }
+  LargeScaleTestCall(100000000, 1 << 16);
+}
+
 /*
  * Score: 5
  * Description: Same as MixTest2 but with 100k integer keys
@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <thread>  // NOLINT
+#include <utility>
 #include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
@@ -444,6 +445,116 @@ void GrowShrinkTestCall(KeyType k /* unused */, ValueType v /* unused */, KeyCom
   delete bpm;
 }
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void BulkLoadTestCall(KeyType k /* unused */, ValueType v /* unused */, KeyComparator comparator) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(10, disk_manager);
+  ExtendibleHashTable<KeyType, ValueType, KeyComparator> ht("blah", bpm, comparator, HashFunction<KeyType>());
+
+  // load an empty table, with one duplicate pair
+  std::vector<std::pair<KeyType, ValueType>> entries;
+  for (int i = 0; i < 5000; i++) {
+    entries.emplace_back(GetKey<KeyType>(i), GetValue<ValueType>(i));
+  }
+  entries.emplace_back(GetKey<KeyType>(7), GetValue<ValueType>(7));
+  EXPECT_FALSE(ht.BulkLoad(nullptr, entries));
+  EXPECT_GT(ht.GetGlobalDepth(), 0);
+
+  ht.VerifyIntegrity();
+
+  for (int i = 0; i < 5000; i++) {
+    std::vector<ValueType> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, GetKey<KeyType>(i), &res));
+    EXPECT_EQ(1, res.size()) << "Failed to load " << i << std::endl;
+  }
+
+  // load the table again, now that it is not empty, with a second value for every other key
+  entries.clear();
+  for (int i = 0; i < 5000; i += 2) {
+    entries.emplace_back(GetKey<KeyType>(i), GetValue<ValueType>(i + 1));
+  }
+  EXPECT_TRUE(ht.BulkLoad(nullptr, entries));
+
+  ht.VerifyIntegrity();
+
+  // the loaded table splits and merges like any other
+  for (int i = 0; i < 5000; i++) {
+    std::vector<ValueType> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, GetKey<KeyType>(i), &res));
+    EXPECT_EQ(i % 2 == 0 ? 2 : 1, res.size()) << "Failed to load " << i << std::endl;
+    EXPECT_TRUE(ht.Insert(nullptr, GetKey<KeyType>(i), GetValue<ValueType>(i + 2)));
+    EXPECT_TRUE(ht.Remove(nullptr, GetKey<KeyType>(i), GetValue<ValueType>(i)));
+  }
+
+  ht.VerifyIntegrity();
+
+  // load a table in batches: the first batch sizes the directory for all of them, and the later batches are appended
+  // to the buckets already there
+  entries.clear();
+  for (int i = 0; i < 10000; i++) {
+    entries.emplace_back(GetKey<KeyType>(i), GetValue<ValueType>(i));
+  }
+  std::vector<std::pair<KeyType, ValueType>> first_batch(entries.begin(), entries.begin() + 2500);
+  ExtendibleHashTable<KeyType, ValueType, KeyComparator> one_batch_ht("blah", bpm, comparator, HashFunction<KeyType>());
+  EXPECT_TRUE(one_batch_ht.BulkLoad(nullptr, first_batch));
+  ExtendibleHashTable<KeyType, ValueType, KeyComparator> batched_ht("blah", bpm, comparator, HashFunction<KeyType>());
+  for (size_t begin = 0; begin < entries.size(); begin += 2500) {
+    std::vector<std::pair<KeyType, ValueType>> batch(entries.begin() + begin, entries.begin() + begin + 2500);
+    EXPECT_TRUE(batched_ht.BulkLoad(nullptr, batch, entries.size()));
+    EXPECT_GT(batched_ht.GetGlobalDepth(), one_batch_ht.GetGlobalDepth());
+  }
+  batched_ht.VerifyIntegrity();
+  for (int i = 0; i < 10000; i++) {
+    std::vector<ValueType> res;
+    EXPECT_TRUE(batched_ht.GetValue(nullptr, GetKey<KeyType>(i), &res));
+    EXPECT_EQ(1, res.size()) << "Failed to load " << i << std::endl;
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void GetValuesTestCall(KeyType k /* unused */, ValueType v /* unused */, KeyComparator comparator) {
+  // with 4 frames most buckets of a batch can't be pinned together and are looked up one by one
+  for (size_t pool_size : {4, 50}) {
+    auto *disk_manager = new DiskManager("test.db");
+    auto *bpm = new BufferPoolManagerInstance(pool_size, disk_manager);
+    ExtendibleHashTable<KeyType, ValueType, KeyComparator> ht("blah", bpm, comparator, HashFunction<KeyType>());
+
+    for (int i = 0; i < 2000; i++) {
+      EXPECT_TRUE(ht.Insert(nullptr, GetKey<KeyType>(i), GetValue<ValueType>(i)));
+      if (i % 3 == 0) {
+        EXPECT_TRUE(ht.Insert(nullptr, GetKey<KeyType>(i), GetValue<ValueType>(i + 1)));
+      }
+    }
+
+    // look up every key, some twice, and keys that are not in the table
+    std::vector<KeyType> keys;
+    for (int i = 0; i < 2500; i++) {
+      keys.push_back(GetKey<KeyType>(i));
+    }
+    keys.push_back(GetKey<KeyType>(7));
+    std::vector<std::vector<ValueType>> results;
+    EXPECT_EQ(2001, ht.GetValues(nullptr, keys, &results));
+    ASSERT_EQ(keys.size(), results.size());
+    for (size_t i = 0; i < keys.size(); i++) {
+      std::vector<ValueType> res;
+      ht.GetValue(nullptr, keys[i], &res);
+      EXPECT_EQ(res, results[i]) << "Failed to look up " << i << std::endl;
+    }
+
+    ht.VerifyIntegrity();
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete disk_manager;
+    delete bpm;
+  }
+}
+
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void GenericTestCall(void (*func)(KeyType, ValueType, KeyComparator)) {
   Schema schema(std::vector<Column>({Column("A", TypeId::BIGINT)}));
@@ -489,6 +600,24 @@ TEST(HashTableTest, GrowShrinkTest) {
   GenericTestCall<GenericKey<64>, RID, GenericComparator<64>>(GrowShrinkTestCall);
 }
 
+TEST(HashTableTest, BulkLoadTest) {
+  BulkLoadTestCall(1, 1, IntComparator());
+
+  GenericTestCall<GenericKey<8>, RID, GenericComparator<8>>(BulkLoadTestCall);
+  GenericTestCall<GenericKey<16>, RID, GenericComparator<16>>(BulkLoadTestCall);
+  GenericTestCall<GenericKey<32>, RID, GenericComparator<32>>(BulkLoadTestCall);
+  GenericTestCall<GenericKey<64>, RID, GenericComparator<64>>(BulkLoadTestCall);
+}
+
+TEST(HashTableTest, GetValuesTest) {
+  GetValuesTestCall(1, 1, IntComparator());
+
+  GenericTestCall<GenericKey<8>, RID, GenericComparator<8>>(GetValuesTestCall);
+  GenericTestCall<GenericKey<16>, RID, GenericComparator<16>>(GetValuesTestCall);
+  GenericTestCall<GenericKey<32>, RID, GenericComparator<32>>(GetValuesTestCall);
+  GenericTestCall<GenericKey<64>, RID, GenericComparator<64>>(GetValuesTestCall);
+}
+
 TEST(HashTableTest, IntegratedConcurrencyTest) {
   const int num_threads = 5;
   const int num_runs = 50;
@@ -10,7 +10,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <cstdlib>
 #include <cstring>
+#include <fstream>
+#include <iterator>
+#include <utility>
+#include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
@@ -24,12 +29,18 @@ class DiskManagerTest : public ::testing::Test {
   void SetUp() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
+    remove("test.crc");
+    remove("test.cmap");
   }
 
   // This function is called after every test.
   void TearDown() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
+    remove("test.crc");
+    remove("test.cmap");
   };
 };
 
@@ -72,6 +83,255 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, FreePageMapTest) {
+  char data[PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  {
+    auto dm = DiskManager(db_file);
+    dm.WritePage(20, data);
+    EXPECT_EQ(21, dm.GetNumPages());
+    EXPECT_TRUE(dm.GetFreePages().empty());
+
+    dm.DeallocatePage(3);
+    dm.DeallocatePage(17);
+    dm.DeallocatePage(9);
+    dm.ReusePage(9);
+    EXPECT_EQ(std::vector<page_id_t>({3, 17}), dm.GetFreePages());
+
+    // The changes are written to the map file before the next page write, e.g. of the reused page.
+    EXPECT_FALSE(std::ifstream("test.fsm").is_open());
+    dm.WritePage(9, data);
+    std::ifstream fsm_in("test.fsm", std::ios::binary);
+    std::vector<char> fsm((std::istreambuf_iterator<char>(fsm_in)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(std::vector<char>({1 << 3, 0, 1 << 1}), fsm);
+    dm.ShutDown();
+  }
+
+  // The free-page map outlives the disk manager.
+  {
+    auto dm = DiskManager(db_file);
+    EXPECT_EQ(std::vector<page_id_t>({3, 17}), dm.GetFreePages());
+    dm.ShutDown();
+  }
+
+  // A new database file starts without free pages, even if an old map is still around.
+  remove("test.db");
+  auto dm = DiskManager(db_file);
+  EXPECT_EQ(0, dm.GetNumPages());
+  EXPECT_TRUE(dm.GetFreePages().empty());
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, SubmitRequestsTest) {
+  const size_t num_pages = 300;
+  std::string db_file("test.db");
+  for (auto backend : {DiskBackend::SYNC, DiskBackend::IO_URING}) {
+    for (bool direct_io : {false, true}) {
+      remove("test.db");
+      auto dm = DiskManager(db_file, backend, direct_io);
+      // Direct I/O needs aligned buffers, the disk manager bounces unaligned ones.
+      auto *buffers = static_cast<char *>(aligned_alloc(PAGE_SIZE, (num_pages + 2) * PAGE_SIZE));
+      char *unaligned = buffers + num_pages * PAGE_SIZE + 1;
+
+      // Scenario: more writes than fit in flight at once, waited for in any order.
+      std::vector<DiskRequest> writes(num_pages);
+      std::vector<DiskRequest *> requests;
+      for (size_t i = 0; i < num_pages; ++i) {
+        snprintf(buffers + i * PAGE_SIZE, PAGE_SIZE, "page %zu", i);
+        writes[i].is_write_ = true;
+        writes[i].page_id_ = static_cast<page_id_t>(i);
+        writes[i].data_ = buffers + i * PAGE_SIZE;
+        requests.push_back(&writes[i]);
+      }
+      dm.SubmitRequests(requests);
+      for (size_t i = num_pages; i > 0; --i) {
+        dm.WaitForRequest(&writes[i - 1]);
+        EXPECT_TRUE(writes[i - 1].success_);
+      }
+      EXPECT_EQ(num_pages, dm.GetNumWrites());
+
+      // Scenario: reads see the writes, and a read past the end of the file yields zeros.
+      memset(buffers, 1, num_pages * PAGE_SIZE);
+      std::vector<DiskRequest> reads(3);
+      reads[0].page_id_ = 7;
+      reads[0].data_ = buffers;
+      reads[1].page_id_ = static_cast<page_id_t>(num_pages + 5);
+      reads[1].data_ = buffers + PAGE_SIZE;
+      reads[2].page_id_ = 299;
+      reads[2].data_ = unaligned;
+      dm.SubmitRequests({&reads[0], &reads[1], &reads[2]});
+      for (auto &read : reads) {
+        dm.WaitForRequest(&read);
+        EXPECT_TRUE(read.success_);
+      }
+      EXPECT_EQ(0, strcmp(buffers, "page 7"));
+      EXPECT_EQ(0, buffers[PAGE_SIZE]);
+      EXPECT_EQ(0, buffers[2 * PAGE_SIZE - 1]);
+      EXPECT_EQ(0, strcmp(unaligned, "page 299"));
+
+      // Scenario: synchronous I/O on an unaligned buffer.
+      dm.WritePage(2, unaligned);
+      dm.ReadPage(2, buffers);
+      EXPECT_EQ(0, strcmp(buffers, "page 299"));
+
+      dm.ShutDown();
+      free(buffers);
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ChecksumTest) {
+  const page_id_t num_pages = 8;
+  std::vector<std::vector<char>> pages(num_pages, std::vector<char>(PAGE_SIZE));
+  std::vector<char> buf(PAGE_SIZE);
+  std::string db_file("test.db");
+  auto *dm = new DiskManager(db_file, DiskBackend::IO_URING, false, true);
+  EXPECT_TRUE(dm->HasChecksums());
+  std::vector<const char *> run;
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    snprintf(pages[i].data(), PAGE_SIZE, "page %d", i);
+    run.push_back(pages[i].data());
+  }
+  EXPECT_TRUE(dm->WritePages(0, run));
+  dm->ReadPage(3, buf.data());
+  EXPECT_EQ(pages[3], buf);
+  dm->ShutDown();
+  delete dm;
+
+  // Scenario: a page changed behind the disk manager's back, e.g. by a torn write, fails every kind of read.
+  FILE *db = fopen("test.db", "r+b");
+  ASSERT_NE(nullptr, db);
+  fseek(db, 5 * PAGE_SIZE + 100, SEEK_SET);
+  fputc('x', db);
+  fclose(db);
+  dm = new DiskManager(db_file, DiskBackend::IO_URING, false, true);
+  EXPECT_THROW(dm->ReadPage(5, buf.data()), PageCorruptionException);
+  std::vector<char> other_buf(PAGE_SIZE);
+  EXPECT_FALSE(dm->ReadPages({{4, other_buf.data()}, {5, buf.data()}}));
+  EXPECT_EQ(pages[4], other_buf);
+  DiskRequest request;
+  request.page_id_ = 5;
+  request.data_ = buf.data();
+  dm->SubmitRequests({&request});
+  dm->WaitForRequest(&request);
+  EXPECT_FALSE(request.success_);
+  EXPECT_EQ(3, dm->GetNumChecksumFailures());
+  // Pages past the end of the file have no checksum, and rewriting a page gives it a new one.
+  dm->ReadPage(num_pages, buf.data());
+  dm->WritePage(5, pages[5].data());
+  dm->ReadPage(5, buf.data());
+  EXPECT_EQ(pages[5], buf);
+
+  // Scenario: a page that changes while its write is in flight, as an unlatched flush allows, still reads back as
+  // written, and its checksum matches that.
+  std::vector<char> changing_page(pages[2]);
+  DiskRequest write_request;
+  write_request.is_write_ = true;
+  write_request.page_id_ = 2;
+  write_request.data_ = changing_page.data();
+  dm->SubmitRequests({&write_request});
+  changing_page[100] = 'x';
+  dm->WaitForRequest(&write_request);
+  EXPECT_TRUE(write_request.success_);
+  dm->ReadPage(2, buf.data());
+  EXPECT_EQ(pages[2], buf);
+  dm->ShutDown();
+  delete dm;
+
+  // Scenario: writing without checksums drops the checksums, which no longer hold.
+  dm = new DiskManager(db_file);
+  dm->WritePage(6, pages[7].data());
+  dm->ShutDown();
+  delete dm;
+  dm = new DiskManager(db_file, DiskBackend::IO_URING, false, true);
+  dm->ReadPage(6, buf.data());
+  EXPECT_EQ(pages[7], buf);
+  dm->ShutDown();
+  delete dm;
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, CompressionTest) {
+  const page_id_t num_pages = 16;
+  std::vector<std::vector<char>> pages(num_pages, std::vector<char>(PAGE_SIZE));
+  std::vector<char> buf(PAGE_SIZE);
+  std::string db_file("test.db");
+  auto *dm = new DiskManager(db_file, DiskBackend::IO_URING, false, true, true);
+  EXPECT_TRUE(dm->IsCompressed());
+  std::vector<const char *> run;
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    for (size_t j = 0; j < PAGE_SIZE / 2; j += 64) {
+      snprintf(pages[i].data() + j, 64, "page %d row %zu", i, j);
+    }
+    run.push_back(pages[i].data());
+  }
+  // a page that does not compress is stored as is
+  for (auto &byte : pages[7]) {
+    byte = static_cast<char>(rand());  // NOLINT
+  }
+  EXPECT_TRUE(dm->WritePages(0, run));
+  EXPECT_EQ(num_pages, dm->GetNumPages());
+  EXPECT_LT(dm->GetStoredBytes(), static_cast<uint64_t>(num_pages) * PAGE_SIZE / 2);
+  page_id_t mapped_pages;
+  EXPECT_EQ(nullptr, dm->MapFile(&mapped_pages));
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    dm->ReadPage(i, buf.data());
+    EXPECT_EQ(pages[i], buf);
+  }
+
+  // Scenario: pages that grow and shrink move between extents, and everything survives reopening.
+  std::swap(pages[3], pages[7]);
+  dm->WritePage(3, pages[3].data());
+  dm->WritePage(7, pages[7].data());
+  pages[num_pages - 1].assign(PAGE_SIZE, 0);
+  dm->WritePage(num_pages - 1, pages[num_pages - 1].data());
+  dm->ReadPage(num_pages + 10, buf.data());
+  EXPECT_EQ(std::vector<char>(PAGE_SIZE), buf);
+  dm->ShutDown();
+  delete dm;
+  EXPECT_THROW(DiskManager(db_file, DiskBackend::IO_URING), Exception);
+  dm = new DiskManager(db_file, DiskBackend::IO_URING, false, true, true);
+  DiskRequest request;
+  request.page_id_ = 3;
+  request.data_ = buf.data();
+  dm->SubmitRequests({&request});
+  dm->WaitForRequest(&request);
+  EXPECT_TRUE(request.success_);
+  EXPECT_EQ(pages[3], buf);
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    dm->ReadPage(i, buf.data());
+    EXPECT_EQ(pages[i], buf);
+  }
+  EXPECT_EQ(0, dm->GetNumChecksumFailures());
+  dm->ShutDown();
+  delete dm;
+
+  // Scenario: rewritten pages leave their old extents free, and free extents next to each other merge, so a page too
+  // big for either of them alone still fits in their space instead of growing the file.
+  remove("test.db");
+  dm = new DiskManager(db_file, DiskBackend::SYNC, false, false, true);
+  std::vector<char> half_random(PAGE_SIZE);
+  for (size_t j = 0; j < PAGE_SIZE / 2; ++j) {
+    half_random[j] = static_cast<char>(rand());  // NOLINT
+  }
+  for (page_id_t i = 0; i < 4; ++i) {
+    dm->WritePage(i, half_random.data());
+  }
+  std::vector<char> zeros(PAGE_SIZE);
+  dm->WritePage(1, zeros.data());
+  dm->WritePage(2, zeros.data());
+  auto file_size = std::ifstream(db_file, std::ios::binary | std::ios::ate).tellg();
+  dm->WritePage(4, pages[3].data());
+  EXPECT_EQ(file_size, std::ifstream(db_file, std::ios::binary | std::ios::ate).tellg());
+  dm->ReadPage(4, buf.data());
+  EXPECT_EQ(pages[3], buf);
+  dm->ShutDown();
+  delete dm;
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
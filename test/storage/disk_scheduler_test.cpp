@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler_test.cpp
+//
+// Identification: test/storage/disk_scheduler_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <future>  // NOLINT
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk/disk_scheduler.h"
+
+namespace bustub {
+
+class DiskSchedulerTest : public ::testing::Test {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+  };
+};
+
+// NOLINTNEXTLINE
+TEST_F(DiskSchedulerTest, ScheduleTest) {
+  const size_t num_pages = 100;
+  auto *disk_manager = new DiskManager("test.db");
+  auto *scheduler = new DiskScheduler(disk_manager);
+  std::vector<std::vector<char>> pages(num_pages, std::vector<char>(PAGE_SIZE));
+
+  // Scenario: writes queued together in random order land in page id order, adjacent ones merged.
+  std::vector<std::pair<page_id_t, const char *>> writes;
+  for (size_t i = 0; i < num_pages; ++i) {
+    snprintf(pages[i].data(), PAGE_SIZE, "page %zu", i);
+    writes.emplace_back(static_cast<page_id_t>(i), pages[i].data());
+  }
+  std::shuffle(writes.begin(), writes.end(), std::default_random_engine(0));
+  for (auto &write : scheduler->ScheduleWrites(writes)) {
+    EXPECT_TRUE(write.get());
+  }
+  EXPECT_GT(scheduler->GetNumMergedWrites(), 0);
+  EXPECT_EQ(num_pages, disk_manager->GetNumWrites());
+
+  // Scenario: reads report their completion through futures or callbacks.
+  std::vector<char> data(PAGE_SIZE);
+  EXPECT_TRUE(scheduler->ScheduleRead(42, data.data()).get());
+  EXPECT_EQ(0, strcmp(data.data(), "page 42"));
+  std::vector<std::vector<char>> reads(num_pages, std::vector<char>(PAGE_SIZE));
+  std::atomic<size_t> num_done{0};
+  std::promise<void> all_done;
+  for (size_t i = 0; i < num_pages; ++i) {
+    scheduler->ScheduleRead(static_cast<page_id_t>(i), reads[i].data(), [&](bool success) {
+      EXPECT_TRUE(success);
+      if (++num_done == num_pages) {
+        all_done.set_value();
+      }
+    });
+  }
+  all_done.get_future().wait();
+  for (size_t i = 0; i < num_pages; ++i) {
+    EXPECT_EQ(pages[i], reads[i]);
+  }
+
+  // Scenario: requests still queued when the scheduler goes away are carried out.
+  snprintf(data.data(), PAGE_SIZE, "last page");
+  scheduler->ScheduleWrite(static_cast<page_id_t>(num_pages), data.data(), [](bool success) {});
+  delete scheduler;
+  std::vector<char> last(PAGE_SIZE);
+  disk_manager->ReadPage(static_cast<page_id_t>(num_pages), last.data());
+  EXPECT_EQ(0, strcmp(last.data(), "last page"));
+
+  disk_manager->ShutDown();
+  delete disk_manager;
+}
+
+}  // namespace bustub